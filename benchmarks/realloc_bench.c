@@ -0,0 +1,108 @@
+/**
+ * @file realloc_bench.c
+ * @brief Benchmark of memforge_realloc on mapped blocks
+ *
+ * Doubles blocks of 1 MiB to 256 MiB and compares memforge_realloc, which
+ * resizes mapped blocks with mremap, against the allocate-copy-free
+ * sequence a realloc without it would perform. Every block is filled
+ * before it is resized, so the copy touches resident pages.
+ *
+ * Usage: ./realloc_bench [rounds]
+ *
+ * @author KyloReneo
+ * @date 2025
+ * @license GPLv3.0
+ */
+
+#include "memforge/memforge.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * now_us - Reads the monotonic clock in microseconds
+ */
+static double now_us(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1e6 + (double)now.tv_nsec / 1e3;
+}
+
+/**
+ * realloc_copy - Grows a block the way a realloc without mremap would
+ */
+static void *realloc_copy(void *ptr, size_t old_size, size_t size)
+{
+    void *moved = memforge_malloc(size);
+    if (moved != NULL)
+    {
+        memcpy(moved, ptr, old_size);
+        memforge_free(ptr);
+    }
+    return moved;
+}
+
+/**
+ * time_growth - Mean time in microseconds to double a filled block of size bytes
+ */
+static double time_growth(size_t size, int rounds, int use_realloc)
+{
+    double total = 0.0;
+
+    for (int i = 0; i < rounds; i++)
+    {
+        char *ptr = memforge_malloc(size);
+        if (ptr == NULL)
+        {
+            return -1.0;
+        }
+        memset(ptr, i, size);
+
+        double start = now_us();
+        char *grown = use_realloc ? memforge_realloc(ptr, 2 * size) : realloc_copy(ptr, size, 2 * size);
+        total += now_us() - start;
+
+        if (grown == NULL)
+        {
+            memforge_free(ptr);
+            return -1.0;
+        }
+        memforge_free(grown);
+    }
+
+    return total / rounds;
+}
+
+int main(int argc, char **argv)
+{
+    int rounds = argc > 1 ? atoi(argv[1]) : 10;
+    if (rounds <= 0)
+    {
+        rounds = 10;
+    }
+
+    memforge_init(NULL);
+    memforge_set_mmap_threshold(128 * 1024); // Keep every block mapped
+
+    printf("Doubling a filled mapped block (%d rounds, mean time)\n", rounds);
+    printf("%12s %16s %16s %10s\n", "size", "realloc (us)", "copy (us)", "speedup");
+
+    for (size_t size = (size_t)1 << 20; size <= (size_t)256 << 20; size *= 2)
+    {
+        double remapped = time_growth(size, rounds, 1);
+        double copied = time_growth(size, rounds, 0);
+        if (remapped < 0.0 || copied < 0.0)
+        {
+            printf("%9zu MiB  out of memory\n", size >> 20);
+            break;
+        }
+
+        printf("%9zu MiB %16.1f %16.1f %9.1fx\n", size >> 20, remapped, copied, copied / remapped);
+    }
+
+    memforge_cleanup();
+    return 0;
+}
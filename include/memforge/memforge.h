@@ -21,6 +21,7 @@
 #ifndef MEMFORGE_H
 #define MEMFORGE_H
 
+#include "memforge_config.h"
 #include <stdio.h>
 #include <stddef.h>
 #include <stdbool.h>
@@ -61,13 +62,86 @@ extern "C"
     typedef enum arena_strategies
     {
         MEMFORGE_ARENA_DEFAULT = 0,      /**< Auto-select based on system heuristics */
-        MEMFORGE_ARENA_PER_THREAD,       /**< One arena per thread (best performance, higher memory) */
+        MEMFORGE_ARENA_PER_THREAD,       /**< One arena per thread, pooled for reuse when it exits */
         MEMFORGE_ARENA_ROUND_ROBIN,      /**< Round-robin distribution (good balance) */
-        MEMFORGE_ARENA_CONTENTION_AWARE, /**< Smart allocation based on lock contention */
+        MEMFORGE_ARENA_CONTENTION_AWARE, /**< Move to the least-contended arena when ours is busy */
         MEMFORGE_ARENA_SINGLE,           /**< Single arena (minimal memory usage) */
-        MEMFORGE_ARENA_CUSTOM            /**< User-provided mapping function */
+        MEMFORGE_ARENA_CUSTOM            /**< User-provided mapping function (config::arena_mapper) */
     } memforge_arena_strategy_t;
 
+    /**
+     * @brief Huge page backing for heap segments and large blocks
+     *
+     * Heap segments and mapped blocks of at least MEMFORGE_HUGE_PAGE_SIZE
+     * are placed on huge page boundaries so the kernel can back them with
+     * huge pages and cut TLB misses on large working sets.
+     */
+    typedef enum huge_page_modes
+    {
+        MEMFORGE_HUGE_PAGES_DEFAULT = 0,  /**< Same as MEMFORGE_HUGE_PAGES_TRANSPARENT */
+        MEMFORGE_HUGE_PAGES_NONE,         /**< Plain mappings, no advice */
+        MEMFORGE_HUGE_PAGES_TRANSPARENT,  /**< Huge-page-aligned mappings with madvise(MADV_HUGEPAGE) */
+        MEMFORGE_HUGE_PAGES_HUGETLB       /**< MAP_HUGETLB from reserved hugetlbfs pages, transparent as fallback */
+    } memforge_huge_pages_t;
+
+    /**
+     * @brief Opaque memory arena handle
+     *
+     * Arenas created with memforge_arena_new() are heaps managed by the
+     * caller: every block allocated from one is released at once by
+     * memforge_arena_destroy().
+     */
+    typedef struct memforge_arena memforge_arena_t;
+
+    /**
+     * @brief Opaque typed object cache handle
+     *
+     * A cache hands out objects of one size from slabs of its own and
+     * keeps freed objects in their constructed state.
+     */
+    typedef struct memforge_cache memforge_cache_t;
+
+    /**
+     * @brief Object constructor or destructor of a memforge_cache_t
+     *
+     * @param[in] object Object being constructed or destroyed
+     */
+    typedef void (*memforge_cache_fn_t)(void *object);
+
+    /**
+     * @brief Opaque bump-pointer region handle
+     *
+     * A region hands out memory by advancing a pointer through chunks it
+     * maps from the OS. Individual allocations are never freed: memory is
+     * reclaimed by rolling back to a mark or by resetting the region.
+     */
+    typedef struct memforge_region memforge_region_t;
+
+    /**
+     * @brief Position in a region saved by memforge_region_mark()
+     *
+     * @note Treat as opaque; only meaningful for the region it came from
+     */
+    typedef struct memforge_region_mark
+    {
+        void *chunk; /**< Chunk being filled when the mark was taken */
+        void *top;   /**< Next free byte in that chunk */
+    } memforge_region_mark_t;
+
+    /**
+     * @brief Maps the calling thread to an arena (MEMFORGE_ARENA_CUSTOM)
+     *
+     * Called once per thread, on its first allocation; the result is cached
+     * in thread-local storage. Indices at or above the arena count wrap
+     * around.
+     *
+     * @param[in] context The arena_mapper_context given with the mapper
+     * @return size_t Index of the arena the calling thread should use
+     *
+     * @see memforge_set_arena_mapper()
+     */
+    typedef size_t (*memforge_arena_mapper_t)(void *context);
+
     /**
      * @brief Allocator configuration structure
      *
@@ -82,6 +156,13 @@ extern "C"
      * @var config::mmap_threshold
      * Size threshold for using direct mmap allocations (bytes)
      *
+     * @var config::mmap_threshold_max
+     * Ceiling for the adaptive mmap threshold (0 = MEMFORGE_MMAP_THRESHOLD_MAX)
+     *
+     * @var config::mmap_threshold_fixed
+     * Keep mmap_threshold as configured instead of raising it when mapped
+     * blocks are freed
+     *
      * @var config::strategy
      * Allocation strategy for block selection
      *
@@ -92,7 +173,40 @@ extern "C"
      * Enable debug output and additional checks
      *
      * @var config::arena_count
-     * Number of memory arenas for multi-threaded operation
+     * Number of shared memory arenas for multi-threaded operation
+     * (MEMFORGE_ARENA_PER_THREAD creates per-thread arenas on top)
+     *
+     * @var config::thread_cache_enabled
+     * Enable per-thread caches of recently freed small blocks
+     *
+     * @var config::thread_cache_size
+     * Maximum number of blocks cached per size class in each thread
+     *
+     * @var config::arena_strategy
+     * How threads are mapped to arenas (default: round-robin)
+     *
+     * @var config::arena_mapper
+     * Thread-to-arena callback used by MEMFORGE_ARENA_CUSTOM
+     *
+     * @var config::arena_mapper_context
+     * Opaque pointer passed to arena_mapper
+     *
+     * @var config::cpu_cache_enabled
+     * Cache freed blocks per logical CPU instead of per thread, so cache
+     * memory is bounded by the core count (Linux rseq, x86-64). Takes
+     * effect whatever thread_cache_enabled says; falls back to per-thread
+     * caches when rseq is unavailable
+     *
+     * @var config::huge_pages
+     * Huge page backing of heap segments and large mapped blocks
+     *
+     * @var config::purge_decay_ms
+     * Milliseconds a free heap page may stay resident before it is returned
+     * to the kernel (0 = MEMFORGE_PURGE_DECAY_MS, SIZE_MAX = never)
+     *
+     * @var config::purge_thread
+     * Purge decayed pages from a background thread as well, so memory is
+     * returned even when the program stops freeing (requires thread_safe)
      *
      * @see memforge_init()
      * @see memforge_config_t
@@ -101,10 +215,21 @@ extern "C"
     {
         size_t page_size;             /**< System page size in bytes */
         size_t mmap_threshold;        /**< MMAP threshold in bytes */
+        size_t mmap_threshold_max;    /**< Ceiling of the adaptive threshold */
+        bool mmap_threshold_fixed;    /**< Adaptive threshold disabled */
         memforge_strategy_t strategy; /**< Allocation strategy */
         bool thread_safe;             /**< Thread safety enabled */
         bool debug_enabled;           /**< Debug output enabled */
         size_t arena_count;           /**< Number of memory arenas */
+        bool thread_cache_enabled;    /**< Per-thread block caches enabled */
+        size_t thread_cache_size;     /**< Cached blocks per size class */
+        bool cpu_cache_enabled;       /**< Per-CPU caches (Linux rseq) instead of per-thread */
+        memforge_arena_strategy_t arena_strategy; /**< Thread-to-arena mapping */
+        memforge_arena_mapper_t arena_mapper;     /**< MEMFORGE_ARENA_CUSTOM callback */
+        void *arena_mapper_context;               /**< Argument for arena_mapper */
+        memforge_huge_pages_t huge_pages;         /**< Huge page backing */
+        size_t purge_decay_ms;                    /**< Dirty page decay window */
+        bool purge_thread;                        /**< Background purging */
     } memforge_config_t;
 
     /**
@@ -137,24 +262,147 @@ extern "C"
      * @var stats::mmap_count
      * Number of direct mmap allocations
      *
+     * @var stats::mmap_cache_hits
+     * Large allocations served by a cached extent instead of a new mmap
+     *
      * @var stats::heap_expansions
      * Number of heap expansion operations
      *
+     * @var stats::thread_cache_hits
+     * Allocations served from the calling thread's cache
+     *
+     * @var stats::thread_cache_misses
+     * Cacheable allocations that had to fall back to an arena
+     *
+     * @var stats::remote_frees
+     * Objects freed into another thread's arena through its remote-free queue
+     *
+     * @var stats::remote_free_drains
+     * Times an arena took a non-empty remote-free queue back in bulk
+     *
+     * @var stats::arena_migrations
+     * Threads moved to another arena after finding theirs locked
+     * (MEMFORGE_ARENA_CONTENTION_AWARE)
+     *
+     * @var stats::huge_page_bytes
+     * Bytes currently mapped huge-page aligned and advised (or backed by
+     * hugetlbfs), i.e. eligible for huge page backing
+     *
+     * @var stats::purged_bytes
+     * Bytes of free heap pages returned to the kernel over the lifetime
+     *
+     * @var stats::realloc_in_place
+     * Reallocs whose contents were not copied: the block still fit, grew
+     * into the free space after it, or was remapped by the kernel
+     *
+     * @var stats::realloc_moved
+     * Reallocs that copied the contents to a new block
+     *
+     * @var stats::class_requested
+     * Bytes requested by callers per size class over the lifetime
+     *
+     * @var stats::class_allocated
+     * Bytes actually handed out per size class over the lifetime; the
+     * internal fragmentation of class i is
+     * 1 - class_requested[i] / class_allocated[i]
+     *
      * @see memforge_get_stats()
      * @see memforge_stats_t
      */
     typedef struct stats
     {
-        size_t total_allocated;  /**< Total bytes allocated */
-        size_t total_freed;      /**< Total bytes freed */
-        size_t current_usage;    /**< Current memory usage */
-        size_t peak_usage;       /**< Peak memory usage */
-        size_t allocation_count; /**< Total allocation calls */
-        size_t free_count;       /**< Total free calls */
-        size_t mmap_count;       /**< Direct mmap allocations */
-        size_t heap_expansions;  /**< Heap expansion operations */
+        size_t total_allocated;     /**< Total bytes allocated */
+        size_t total_freed;         /**< Total bytes freed */
+        size_t current_usage;       /**< Current memory usage */
+        size_t peak_usage;          /**< Peak memory usage */
+        size_t allocation_count;    /**< Total allocation calls */
+        size_t free_count;          /**< Total free calls */
+        size_t mmap_count;          /**< Direct mmap allocations */
+        size_t mmap_cache_hits;     /**< Large allocations reusing a cached extent */
+        size_t heap_expansions;     /**< Heap expansion operations */
+        size_t thread_cache_hits;   /**< Allocations served by thread cache */
+        size_t thread_cache_misses; /**< Thread cache misses */
+        size_t remote_frees;        /**< Cross-arena frees queued */
+        size_t remote_free_drains;  /**< Remote-free queue drains */
+        size_t arena_migrations;    /**< Contention-driven arena switches */
+        size_t huge_page_bytes;     /**< Huge-page-eligible bytes mapped */
+        size_t purged_bytes;        /**< Free heap bytes returned to the kernel */
+        size_t realloc_in_place;    /**< Reallocs done without copying */
+        size_t realloc_moved;       /**< Reallocs that copied to a new block */
+        size_t class_requested[MEMFORGE_SIZE_CLASS_COUNT]; /**< Requested bytes per size class */
+        size_t class_allocated[MEMFORGE_SIZE_CLASS_COUNT]; /**< Handed-out bytes per size class */
     } memforge_stats_t;
 
+    /**
+     * @brief Per-arena statistics
+     *
+     * Lock counters show whether arena_count fits the workload: a high
+     * lock_contentions / lock_acquisitions ratio means threads regularly
+     * find their arena busy and more arenas would help.
+     *
+     * @struct arena_stats
+     *
+     * @var arena_stats::allocated
+     * Bytes allocated from the arena over its lifetime
+     *
+     * @var arena_stats::freed
+     * Bytes returned to the arena over its lifetime
+     *
+     * @var arena_stats::lock_acquisitions
+     * Times the arena lock was taken
+     *
+     * @var arena_stats::lock_contentions
+     * Lock acquisitions that found the arena already locked
+     *
+     * @see memforge_get_arena_stats()
+     */
+    typedef struct arena_stats
+    {
+        size_t allocated;         /**< Bytes allocated */
+        size_t freed;             /**< Bytes freed */
+        size_t lock_acquisitions; /**< Lock acquisitions */
+        size_t lock_contentions;  /**< Acquisitions that had to wait */
+    } memforge_arena_stats_t;
+
+    /**
+     * @brief Occupancy of one typed object cache
+     *
+     * @struct cache_stats
+     *
+     * @var cache_stats::name
+     * Name given to memforge_cache_create()
+     *
+     * @var cache_stats::object_size
+     * Size of every object in bytes, including alignment padding
+     *
+     * @var cache_stats::objects_in_use
+     * Objects currently allocated from the cache
+     *
+     * @var cache_stats::objects_cached
+     * Freed objects kept constructed for reuse
+     *
+     * @var cache_stats::object_capacity
+     * Objects the cache's slabs can hold
+     *
+     * @var cache_stats::slab_count
+     * Slabs currently mapped
+     *
+     * @var cache_stats::slab_size
+     * Bytes per slab
+     *
+     * @see memforge_cache_get_stats()
+     */
+    typedef struct cache_stats
+    {
+        const char *name;       /**< Cache name */
+        size_t object_size;     /**< Bytes per object */
+        size_t objects_in_use;  /**< Allocated objects */
+        size_t objects_cached;  /**< Constructed free objects */
+        size_t object_capacity; /**< Objects the slabs can hold */
+        size_t slab_count;      /**< Mapped slabs */
+        size_t slab_size;       /**< Bytes per slab */
+    } memforge_cache_stats_t;
+
     // ============================================================================
     // PUBLIC API FUNCTIONS
     // ============================================================================
@@ -217,6 +465,24 @@ extern "C"
      */
     void memforge_free(void *ptr);
 
+    /**
+     * @brief Releases memory whose allocation size the caller knows
+     *
+     * Same as memforge_free(), but size lets small blocks find their size
+     * class without reading allocator metadata, which saves a dependent
+     * cache miss on every free. Matches C23 free_sized() and C++ sized
+     * operator delete.
+     *
+     * @param[in] ptr Pointer to memory block to free
+     * @param[in] size Size passed to the allocation call that returned ptr
+     *
+     * @note With MEMFORGE_SAFETY_CHECKS the size is verified against the
+     *       block; on a mismatch it is reported and ignored
+     *
+     * @see memforge_free()
+     */
+    void memforge_free_sized(void *ptr, size_t size);
+
     /**
      * @brief Allocates memory for an array and initializes to zero
      *
@@ -261,6 +527,8 @@ extern "C"
      * @note If ptr is NULL, equivalent to memforge_malloc(size)
      * @note If size is 0 and ptr is not NULL, equivalent to memforge_free(ptr)
      * @note May move the block to a new location if resizing in-place is not possible
+     * @note Blocks mapped directly (above the mmap threshold) are resized with
+     *       mremap: the kernel moves their pages instead of them being copied
      * @note Thread-safe when configured with thread_safe = true
      *
      * @see memforge_malloc()
@@ -275,6 +543,50 @@ extern "C"
      */
     void *memforge_realloc(void *ptr, size_t size);
 
+    /**
+     * @brief Allocates count blocks of size bytes in one call
+     *
+     * Equivalent to count calls to memforge_malloc(size), but blocks are
+     * taken from the thread cache first and the rest come from the arena
+     * under a single lock acquisition, carved next to each other where
+     * possible.
+     *
+     * @param[in] size Size of every block in bytes
+     * @param[in] count Number of blocks wanted
+     * @param[out] out Array of at least count entries receiving the blocks
+     * @return size_t Number of blocks stored in out[0..n-1]
+     *
+     * @retval count Success
+     * @retval <count Out of memory after that many blocks; errno is ENOMEM
+     *
+     * @note Blocks are released individually or with memforge_free_batch()
+     *
+     * @see memforge_free_batch()
+     *
+     * @par Example:
+     * @code
+     * struct node *nodes[256];
+     * size_t n = memforge_malloc_batch(sizeof(struct node), 256, (void **)nodes);
+     * // ...
+     * memforge_free_batch((void **)nodes, n);
+     * @endcode
+     */
+    size_t memforge_malloc_batch(size_t size, size_t count, void **out);
+
+    /**
+     * @brief Frees count blocks in one call
+     *
+     * Equivalent to calling memforge_free() on each entry, but blocks that
+     * do not fit in the thread cache are returned to their arenas taking
+     * each arena lock once per run of blocks from the same arena.
+     *
+     * @param[in] ptrs Blocks to free; NULL entries are ignored
+     * @param[in] count Number of entries in ptrs
+     *
+     * @see memforge_malloc_batch()
+     */
+    void memforge_free_batch(void **ptrs, size_t count);
+
     // Allocator lifecycle management
 
     /**
@@ -443,6 +755,226 @@ extern "C"
      */
     void memforge_get_stats(memforge_stats_t *stats);
 
+    /**
+     * @brief Returns the number of arenas in use
+     *
+     * @return size_t Arena count (0 before initialization)
+     *
+     * @see memforge_get_arena_stats()
+     */
+    size_t memforge_get_arena_count(void);
+
+    /**
+     * @brief Retrieves the statistics of one arena
+     *
+     * @param[in] index Arena index, below memforge_get_arena_count()
+     * @param[out] stats Pointer to statistics structure to fill
+     * @return int 0 on success, -1 if index is out of range or stats is NULL
+     *
+     * @see memforge_arena_stats_t
+     */
+    int memforge_get_arena_stats(size_t index, memforge_arena_stats_t *stats);
+
+    // Caller-managed arenas
+
+    /**
+     * @brief Creates an empty caller-managed arena
+     *
+     * The arena shares nothing with the allocator's own arenas: blocks
+     * allocated from it are never parked in thread or per-CPU caches, so
+     * memforge_arena_destroy() can drop all of them without walking them.
+     *
+     * @return memforge_arena_t* New arena, or NULL on failure
+     *
+     * @see memforge_arena_destroy()
+     */
+    memforge_arena_t *memforge_arena_new(void);
+
+    /**
+     * @brief Allocates size bytes from a caller-managed arena
+     *
+     * @param[in] arena Arena created by memforge_arena_new()
+     * @param[in] size Number of bytes to allocate
+     * @return void* Pointer to allocated memory, or NULL on failure
+     *
+     * @note The mmap threshold does not apply: every block lives in the
+     *       arena's segments, so requests above one segment's capacity
+     *       (about MEMFORGE_HEAP_SEGMENT_SIZE) fail with ENOMEM
+     */
+    void *memforge_arena_malloc(memforge_arena_t *arena, size_t size);
+
+    /**
+     * @brief Returns a block to the caller-managed arena it came from
+     *
+     * Optional: blocks left allocated are released by memforge_arena_destroy().
+     * memforge_free() on such a block is equivalent.
+     *
+     * @param[in] arena Arena the block was allocated from
+     * @param[in] ptr Block to free (NULL is ignored)
+     */
+    void memforge_arena_free(memforge_arena_t *arena, void *ptr);
+
+    /**
+     * @brief Destroys a caller-managed arena and every block allocated from it
+     *
+     * Each segment the arena owns is unmapped at once, no matter how many
+     * blocks are still allocated in it.
+     *
+     * @param[in] arena Arena to destroy (NULL is ignored)
+     *
+     * @warning Every pointer obtained from the arena becomes invalid
+     */
+    void memforge_arena_destroy(memforge_arena_t *arena);
+
+    /**
+     * @brief Retrieves the statistics of a caller-managed arena
+     *
+     * @param[in] arena Arena created by memforge_arena_new()
+     * @param[out] stats Pointer to statistics structure to fill
+     * @return int 0 on success, -1 if arena or stats is NULL
+     */
+    int memforge_arena_get_stats(memforge_arena_t *arena, memforge_arena_stats_t *stats);
+
+    // Typed object caches
+
+    /**
+     * @brief Creates a cache of objects of one size and alignment
+     *
+     * Objects are carved from slabs dedicated to the cache. ctor runs once
+     * when an object is first carved and dtor once when its slab is
+     * released, not on every alloc/free pair: a freed object must be
+     * returned in its constructed state and is handed out again as is.
+     *
+     * @param[in] name Name reported in statistics (copied, may be truncated)
+     * @param[in] size Object size in bytes
+     * @param[in] align Object alignment (power of two), or 0 for MEMFORGE_ALIGNMENT
+     * @param[in] ctor Constructor, or NULL
+     * @param[in] dtor Destructor, or NULL
+     * @return memforge_cache_t* New cache, or NULL on failure
+     *
+     * @see memforge_cache_destroy()
+     */
+    memforge_cache_t *memforge_cache_create(const char *name, size_t size, size_t align,
+                                            memforge_cache_fn_t ctor, memforge_cache_fn_t dtor);
+
+    /**
+     * @brief Allocates a constructed object from a cache
+     *
+     * @param[in] cache Cache to allocate from
+     * @return void* Object, or NULL on failure
+     */
+    void *memforge_cache_alloc(memforge_cache_t *cache);
+
+    /**
+     * @brief Returns an object to its cache
+     *
+     * @param[in] cache Cache the object came from
+     * @param[in] object Object in its constructed state (NULL is ignored)
+     */
+    void memforge_cache_free(memforge_cache_t *cache, void *object);
+
+    /**
+     * @brief Destroys a cache and unmaps its slabs
+     *
+     * dtor runs on every free object; objects still allocated are reported
+     * in debug mode and dropped without it.
+     *
+     * @param[in] cache Cache to destroy (NULL is ignored)
+     */
+    void memforge_cache_destroy(memforge_cache_t *cache);
+
+    /**
+     * @brief Retrieves the occupancy of a cache
+     *
+     * @param[in] cache Cache created by memforge_cache_create()
+     * @param[out] stats Pointer to statistics structure to fill
+     * @return int 0 on success, -1 if cache or stats is NULL
+     */
+    int memforge_cache_get_stats(memforge_cache_t *cache, memforge_cache_stats_t *stats);
+
+    /**
+     * @brief Returns the number of live object caches
+     *
+     * @return size_t Cache count
+     */
+    size_t memforge_get_cache_count(void);
+
+    /**
+     * @brief Retrieves the occupancy of one live object cache
+     *
+     * @param[in] index Cache index, below memforge_get_cache_count()
+     * @param[out] stats Pointer to statistics structure to fill
+     * @return int 0 on success, -1 if index is out of range or stats is NULL
+     */
+    int memforge_get_cache_stats(size_t index, memforge_cache_stats_t *stats);
+
+    // Bump-pointer regions
+
+    /**
+     * @brief Creates an empty region
+     *
+     * @param[in] chunk_size Bytes mapped per chunk, or 0 for
+     *            MEMFORGE_REGION_CHUNK_SIZE
+     * @return memforge_region_t* New region, or NULL on failure
+     *
+     * @note A region is not thread-safe; give each thread its own
+     *
+     * @see memforge_region_destroy()
+     */
+    memforge_region_t *memforge_region_create(size_t chunk_size);
+
+    /**
+     * @brief Allocates size bytes from a region
+     *
+     * Usually a pointer increment. Requests larger than the chunk size get
+     * a chunk of their own.
+     *
+     * @param[in] region Region to allocate from
+     * @param[in] size Number of bytes, aligned to MEMFORGE_ALIGNMENT
+     * @return void* Pointer to the memory, or NULL on failure
+     *
+     * @note The memory must not be passed to memforge_free()
+     */
+    void *memforge_region_alloc(memforge_region_t *region, size_t size);
+
+    /**
+     * @brief Records the current position of a region
+     *
+     * @param[in] region Region to mark
+     * @return memforge_region_mark_t Position to pass to memforge_region_rollback()
+     */
+    memforge_region_mark_t memforge_region_mark(memforge_region_t *region);
+
+    /**
+     * @brief Releases everything allocated from a region since a mark
+     *
+     * O(1): chunks filled after the mark are kept for reuse.
+     *
+     * @param[in] region Region to roll back
+     * @param[in] mark Position saved by memforge_region_mark()
+     *
+     * @warning Marks taken after this one become invalid
+     */
+    void memforge_region_rollback(memforge_region_t *region, memforge_region_mark_t mark);
+
+    /**
+     * @brief Releases everything allocated from a region
+     *
+     * O(1): every chunk is kept for reuse.
+     *
+     * @param[in] region Region to reset
+     */
+    void memforge_region_reset(memforge_region_t *region);
+
+    /**
+     * @brief Unmaps every chunk of a region
+     *
+     * @param[in] region Region to destroy (NULL is ignored)
+     *
+     * @warning Every pointer obtained from the region becomes invalid
+     */
+    void memforge_region_destroy(memforge_region_t *region);
+
     /**
      * @brief Sets the allocation strategy
      *
@@ -461,15 +993,53 @@ extern "C"
      * @brief Sets the mmap allocation threshold
      *
      * Configures the size threshold for using direct mmap allocations
-     * instead of heap allocations.
+     * instead of heap allocations, and stops the threshold from adapting
+     * to freed blocks afterwards (see memforge_get_mmap_threshold()).
      *
      * @param[in] threshold Size threshold in bytes
      *
      * @note Allocations >= threshold will use mmap directly
-     * @note Default is typically 64KB
+     * @note Values up to MEMFORGE_SLAB_MAX_SIZE are raised just above it:
+     *       slab-sized requests are always served by the arenas
      */
     void memforge_set_mmap_threshold(size_t threshold);
 
+    /**
+     * @brief Returns the current mmap threshold
+     *
+     * Unless the threshold is fixed (memforge_config_t::mmap_threshold_fixed
+     * or memforge_set_mmap_threshold()), it starts at the configured value
+     * and is raised each time a mapped block larger than it is freed, up to
+     * memforge_config_t::mmap_threshold_max. A size that keeps being
+     * allocated and freed thus moves from mmap/munmap onto the heap.
+     *
+     * @return size_t Requests of at least this many bytes are mapped directly
+     *         (0 before initialization)
+     */
+    size_t memforge_get_mmap_threshold(void);
+
+    /**
+     * @brief Installs a thread-to-arena mapper and selects MEMFORGE_ARENA_CUSTOM
+     *
+     * Threads that have not allocated yet are mapped by calling mapper once;
+     * threads that already have an arena keep it.
+     *
+     * @param[in] mapper Callback returning an arena index for the calling thread
+     * @param[in] context Opaque pointer passed to every mapper call
+     *
+     * @note The mapper may allocate; allocations it makes are served by the
+     *       main arena
+     *
+     * @par Example:
+     * @code
+     * static size_t pin_io_threads(void *context) {
+     *     return is_io_thread() ? 0 : 1 + compute_worker_id() % 3;
+     * }
+     * memforge_set_arena_mapper(pin_io_threads, NULL);
+     * @endcode
+     */
+    void memforge_set_arena_mapper(memforge_arena_mapper_t mapper, void *context);
+
     // Debugging and diagnostics
 
     /**
@@ -551,20 +1121,37 @@ extern "C"
      * @brief Prints allocation statistics to stdout (compatibility)
      *
      * Prints brief allocation statistics to stdout in a format similar
-     * to other malloc implementations.
+     * to other malloc implementations, followed by the internal
+     * fragmentation of every size class that has been used.
      */
     void memforge_malloc_stats(void);
 
     /**
      * @brief Releases free memory to the operating system (compatibility)
      *
-     * Attempts to release free memory at the end of the heap back to
-     * the operating system.
-     *
-     * @param[in] pad Minimum amount to keep allocated
-     * @return int 1 if memory was released, 0 otherwise
+     * Unmaps the heap and slab segments that hold no allocation, purges the
+     * pages of free heap blocks and empty slab runs, and empties the cache
+     * of freed large mappings, in every arena except those created with
+     * memforge_arena_new(). The calling thread's cache, and with
+     * memforge_config_t::cpu_cache_enabled the cache of the CPU it runs on,
+     * are flushed first.
+     *
+     * @warning Other threads' per-thread caches and other CPUs' caches
+     *          cannot be flushed from here: their blocks stay allocated, and
+     *          so does the memory around them. Per-CPU caches hold at most
+     *          MEMFORGE_CPU_CACHE_SIZE blocks per size class and CPU. After a
+     *          multi-threaded batch job, let the worker threads exit (which
+     *          flushes their per-thread caches) before trimming
+     *
+     * @param[in] pad Free bytes to keep resident at the end of each arena's
+     *                heap, so the next allocations do not fault straight away
+     * @return size_t Number of bytes returned to the operating system,
+     *         counting only pages that may have been resident
+     *
+     * @note Unlike glibc's malloc_trim(), which returns 1 or 0, the byte
+     *       count is returned; it is non-zero exactly when memory was released
      */
-    int memforge_malloc_trim(size_t pad);
+    size_t memforge_malloc_trim(size_t pad);
 
     /**
      * @brief Exports allocator information in XML format (compatibility)
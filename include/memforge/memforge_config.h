@@ -68,7 +68,33 @@
 // COMPILE-TIME CONFIGURATION
 // ============================================================================
 
-// future work!
+/**
+ * @def MEMFORGE_INIT_CONSTRUCTOR
+ * @brief Initialize the allocator from a library constructor
+ *
+ * When 1, memforge_init(NULL) runs before main() and the first allocation
+ * does not pay for setup. Leave at 0 to pass a custom configuration to
+ * memforge_init(); lazy initialization on first use is race-free either way.
+ *
+ * @note Override with -DMEMFORGE_INIT_CONSTRUCTOR=1
+ */
+#ifndef MEMFORGE_INIT_CONSTRUCTOR
+#define MEMFORGE_INIT_CONSTRUCTOR 0
+#endif
+
+/**
+ * @def MEMFORGE_STATS
+ * @brief Collect allocation statistics
+ *
+ * When 0, no counter is updated on any path and memforge_get_stats()
+ * reports zeros. Per-arena lock counters are kept either way since
+ * contention-aware arena selection relies on them.
+ *
+ * @note Override with -DMEMFORGE_STATS=0 for maximum throughput builds
+ */
+#ifndef MEMFORGE_STATS
+#define MEMFORGE_STATS 1
+#endif
 
 // ============================================================================
 // ALLOCATOR CONSTANTS
@@ -127,7 +153,8 @@
  * very small allocations have enough space for the block header and
  * maintain proper alignment.
  *
- * @note Must be at least sizeof(block_header_t) + minimal user data
+ * @note Must be large enough to hold the two free-list links a free heap
+ *       block stores in its user area (free_block_links_t)
  * @note Affects internal fragmentation for small allocations
  */
 #define MEMFORGE_MIN_ALLOC_SIZE 16
@@ -147,21 +174,35 @@
  */
 #define MEMFORGE_DEFAULT_MMAP_THRESHOLD (128 * 1024) // 128KB
 
+/**
+ * @def MEMFORGE_MMAP_THRESHOLD_MAX
+ * @brief Default ceiling of the adaptive mmap threshold
+ *
+ * Freeing a mapped block raises the threshold to the block's mapping size
+ * (as glibc does), so sizes that recur move onto the heap. The ceiling is
+ * half a heap segment, so a block that moves onto the heap never takes a
+ * segment for itself.
+ *
+ * @see memforge_config_t::mmap_threshold_max
+ */
+#define MEMFORGE_MMAP_THRESHOLD_MAX (MEMFORGE_HEAP_SEGMENT_SIZE / 2)
+
 /**
  * @def MEMFORGE_SIZE_CLASS_COUNT
  * @brief Number of size classes for segregated free lists
  *
  * Defines how many different size categories are maintained in the
- * segregated free lists. More classes reduce search time but increase
- * memory overhead for free list management.
+ * segregated free lists. More classes reduce search time and internal
+ * fragmentation but increase memory overhead for free list management.
  *
- * @note Typical values range from 8-32 depending on use case
+ * @note 59 classes: 8-byte steps up to 64 bytes, then four classes per
+ *       doubling up to 512KB
  * @see memforge_size_classes
  */
-#define MEMFORGE_SIZE_CLASS_COUNT 16
+#define MEMFORGE_SIZE_CLASS_COUNT 59
 
 /**
- * @var const size_t memforge_size_classes[MEMFORGE_SIZE_CLASS_COUNT]
+ * @var size_t memforge_size_classes[MEMFORGE_SIZE_CLASS_COUNT]
  * @brief Array of size class boundaries
  *
  * Defines the size boundaries for each free list category. Allocations
@@ -171,7 +212,31 @@
  * @see MEMFORGE_SIZE_CLASS_COUNT
  * @see get_size_class()
  */
-extern const size_t memforge_size_classes[MEMFORGE_SIZE_CLASS_COUNT];
+extern size_t memforge_size_classes[MEMFORGE_SIZE_CLASS_COUNT];
+
+/**
+ * @def MEMFORGE_SMALL_LOOKUP_MAX
+ * @brief Largest size resolved through the byte-granular class table
+ *
+ * Sizes up to this bound are mapped to their size class by a direct table
+ * lookup with one entry per MEMFORGE_ALIGNMENT bytes. Larger sizes go
+ * through the log2-indexed table.
+ *
+ * @note Must be a power of two
+ * @see size_class_init()
+ */
+#define MEMFORGE_SMALL_LOOKUP_MAX 1024
+
+/**
+ * @def MEMFORGE_SIZE_CLASS_LOOKUP_BITS
+ * @brief Mantissa bits used to index the log2 size class table
+ *
+ * Each power-of-two range above MEMFORGE_SMALL_LOOKUP_MAX is split into
+ * 2^MEMFORGE_SIZE_CLASS_LOOKUP_BITS cells. The lookup stays exact for any
+ * class table; it is a single probe as long as no more than this many
+ * classes share one doubling.
+ */
+#define MEMFORGE_SIZE_CLASS_LOOKUP_BITS 3
 
 /**
  * @def MEMFORGE_MAGIC_NUMBER
@@ -179,6 +244,7 @@ extern const size_t memforge_size_classes[MEMFORGE_SIZE_CLASS_COUNT];
  *
  * A unique value stored in each block header to detect memory
  * corruption, use-after-free, and invalid pointer operations.
+ * Only present when MEMFORGE_SAFETY_CHECKS is enabled.
  *
  * @note Changed from default patterns to avoid common crash values
  * @see block_header_t::magic
@@ -186,6 +252,20 @@ extern const size_t memforge_size_classes[MEMFORGE_SIZE_CLASS_COUNT];
  */
 #define MEMFORGE_MAGIC_NUMBER 0xDEADBEEF
 
+/**
+ * @def MEMFORGE_CACHED_MAGIC
+ * @brief Magic number for blocks parked in a thread cache
+ *
+ * Cached blocks still look allocated to their arena, so their magic is
+ * switched to this value while they sit in a cache or in an arena's
+ * remote-free queue. Freeing a block that carries it is reported as a
+ * double free.
+ *
+ * @see thread_cache_free()
+ * @see arena_remote_free()
+ */
+#define MEMFORGE_CACHED_MAGIC 0xCAC4EDB1
+
 // ============================================================================
 // DEBUGGING AND SAFETY FEATURES
 // ============================================================================
@@ -217,10 +297,18 @@ extern const size_t memforge_size_classes[MEMFORGE_SIZE_CLASS_COUNT];
  *
  * @note Recommended for development and testing
  * @note Can be disabled in production for maximum performance
+ * @note Defaults to 0 in NDEBUG (release) builds, where it also drops the
+ *       magic number from block headers; define it explicitly to override
  * @see block_validate()
  * @see heap_validate()
  */
+#ifndef MEMFORGE_SAFETY_CHECKS
+#ifdef NDEBUG
+#define MEMFORGE_SAFETY_CHECKS 0
+#else
 #define MEMFORGE_SAFETY_CHECKS 1
+#endif
+#endif
 
 /**
  * @def MEMFORGE_THREAD_SAFE
@@ -282,6 +370,184 @@ extern const size_t memforge_size_classes[MEMFORGE_SIZE_CLASS_COUNT];
  */
 #define MEMFORGE_DEFAULT_ARENA_COUNT 4
 
+/**
+ * @def MEMFORGE_HYBRID_SEARCH_DEPTH
+ * @brief Candidates examined per free list by the hybrid strategy
+ *
+ * The hybrid strategy searches for the best fit like best-fit, but stops
+ * after this many fitting blocks and takes the smallest seen so far. This
+ * bounds allocation latency on long free lists.
+ *
+ * @see MEMFORGE_STRATEGY_HYBRID
+ */
+#define MEMFORGE_HYBRID_SEARCH_DEPTH 8
+
+/**
+ * @def MEMFORGE_HEAP_SEGMENT_SHIFT
+ * @brief log2 of MEMFORGE_HEAP_SEGMENT_SIZE
+ *
+ * Also the number of low address bits ignored when looking a pointer up
+ * in the segment map.
+ *
+ * @see segment_map_lookup()
+ */
+#define MEMFORGE_HEAP_SEGMENT_SHIFT 22
+
+/**
+ * @def MEMFORGE_HEAP_SEGMENT_SIZE
+ * @brief Size and alignment of every heap segment in bytes
+ *
+ * Arenas grow by mapping segments of exactly this size, aligned to this
+ * size. The alignment lets the allocator find the segment (and therefore
+ * the owning arena) of any heap block by masking its address, without
+ * storing an arena pointer in each block header.
+ *
+ * @note Derived from MEMFORGE_HEAP_SEGMENT_SHIFT so it is always a power of two
+ * @note Must be larger than the mmap threshold
+ * @see heap_segment_t
+ * @see HEAP_SEGMENT_OF()
+ */
+#define MEMFORGE_HEAP_SEGMENT_SIZE ((size_t)1 << MEMFORGE_HEAP_SEGMENT_SHIFT) // 4MB
+
+/**
+ * @def MEMFORGE_HUGE_PAGE_SIZE
+ * @brief Size of the huge pages heap memory is aligned for (x86-64 PMD size)
+ *
+ * MEMFORGE_HEAP_SEGMENT_SIZE is a multiple of it, so every segment is made
+ * of whole huge pages.
+ *
+ * @see memforge_huge_pages_t
+ */
+#define MEMFORGE_HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024) // 2MB
+
+/**
+ * @def MEMFORGE_EXTENT_CACHE_MAX_BYTES
+ * @brief Most bytes of freed mapped blocks kept mapped for reuse
+ *
+ * Freed blocks above the mmap threshold are parked in the extent cache
+ * instead of being unmapped, so the next large allocation of a similar
+ * size skips mmap and the page faults of fresh memory. The oldest extents
+ * are unmapped first when the cache is full.
+ *
+ * @see MEMFORGE_EXTENT_CACHE_DECAY_MS
+ */
+#define MEMFORGE_EXTENT_CACHE_MAX_BYTES ((size_t)64 * 1024 * 1024) // 64MB
+
+/**
+ * @def MEMFORGE_EXTENT_CACHE_MAX_EXTENT
+ * @brief Largest freed mapping the extent cache keeps
+ */
+#define MEMFORGE_EXTENT_CACHE_MAX_EXTENT ((size_t)16 * 1024 * 1024) // 16MB
+
+/**
+ * @def MEMFORGE_EXTENT_CACHE_DECAY_MS
+ * @brief Milliseconds an unused extent stays cached before it is unmapped
+ */
+#define MEMFORGE_EXTENT_CACHE_DECAY_MS 1000
+
+/**
+ * @def MEMFORGE_PURGE_DECAY_MS
+ * @brief Default time a free heap page stays resident before it is purged
+ *
+ * Pages inside free heap blocks are returned to the kernel only after
+ * they have gone unused this long, so memory freed after a load spike is
+ * released without a steady workload re-faulting the pages it keeps
+ * reusing.
+ *
+ * @see memforge_config_t::purge_decay_ms
+ */
+#define MEMFORGE_PURGE_DECAY_MS 10000
+
+/**
+ * @def MEMFORGE_SLAB_RUN_SIZE
+ * @brief Size of one slab run in bytes
+ *
+ * Small size classes are served from runs: page-sized, page-aligned chunks
+ * of a slab segment that hold objects of a single size class back to back.
+ * All bookkeeping lives in a per-run descriptor, so slab objects carry no
+ * block header.
+ *
+ * @see slab_run_t
+ */
+#define MEMFORGE_SLAB_RUN_SIZE 4096
+
+/**
+ * @def MEMFORGE_SLAB_MAX_SIZE
+ * @brief Largest size class served from slab runs
+ *
+ * Classes up to this size are header-less slab objects; larger classes use
+ * heap blocks with a block_header_t.
+ *
+ * @note Must not exceed MEMFORGE_SLAB_RUN_SIZE / 4 so a run holds several objects
+ */
+#define MEMFORGE_SLAB_MAX_SIZE 1024
+
+/**
+ * @def MEMFORGE_THREAD_CACHE_SIZE
+ * @brief Default number of blocks cached per size class in each thread
+ *
+ * Bounds how many freed blocks a thread keeps for reuse in each size class
+ * before returning half of them to their owning arenas in one batch.
+ *
+ * @note Can be overridden at runtime via memforge_config_t::thread_cache_size
+ * @see thread_cache_t
+ */
+#define MEMFORGE_THREAD_CACHE_SIZE 32
+
+/**
+ * @def MEMFORGE_THREAD_CACHE_MAX_SIZE
+ * @brief Largest block size (in bytes) eligible for thread caching
+ *
+ * Larger blocks are always returned to their arena so that per-thread
+ * caches cannot pin large amounts of memory.
+ */
+#define MEMFORGE_THREAD_CACHE_MAX_SIZE (32 * 1024) // 32KB
+
+/**
+ * @def MEMFORGE_CPU_CACHE_SIZE
+ * @brief Capacity of each per-CPU cache bin
+ *
+ * Per-CPU bins are fixed arrays so that rseq critical sections can push
+ * and pop with a single committing store. The effective limit is the
+ * smaller of this and memforge_config_t::thread_cache_size.
+ *
+ * @see cpu_cache_t
+ */
+#define MEMFORGE_CPU_CACHE_SIZE 32
+
+/**
+ * @def MEMFORGE_CACHE_SLAB_SIZE
+ * @brief Minimum size of a typed object cache slab in bytes
+ *
+ * Slabs are aligned to their size so an object's slab is found by masking
+ * its address. Caches of large objects use the next power of two that
+ * holds MEMFORGE_CACHE_SLAB_MIN_OBJECTS of them.
+ *
+ * @see memforge_cache_create()
+ */
+#define MEMFORGE_CACHE_SLAB_SIZE (64 * 1024) // 64KB
+
+/**
+ * @def MEMFORGE_CACHE_SLAB_MIN_OBJECTS
+ * @brief Fewest objects a typed object cache slab holds
+ */
+#define MEMFORGE_CACHE_SLAB_MIN_OBJECTS 8
+
+/**
+ * @def MEMFORGE_CACHE_NAME_MAX
+ * @brief Bytes kept of a typed object cache's name, terminator included
+ */
+#define MEMFORGE_CACHE_NAME_MAX 32
+
+/**
+ * @def MEMFORGE_REGION_CHUNK_SIZE
+ * @brief Default size of the chunks a region maps from the OS
+ *
+ * @note Can be overridden per region via memforge_region_create()
+ * @see memforge_region_t
+ */
+#define MEMFORGE_REGION_CHUNK_SIZE (64 * 1024) // 64KB
+
 #endif
 
 // Old configuration
@@ -19,7 +19,10 @@
 #define MEMFORGE_INTERNAL_H
 
 #include "memforge_config.h"
+#include "memforge.h"
 #include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
 
@@ -30,340 +33,1716 @@
 /**
  * @brief Block header structure stored before each allocation
  *
- * This structure precedes every memory allocation in the heap and contains
- * metadata needed for memory management. The header is invisible to users
- * and is used internally for block tracking, free list management, and
- * corruption detection.
+ * This structure precedes every heap and mmap'd allocation (slab objects
+ * have none) and contains the metadata needed for memory management. The
+ * header is invisible to users and kept as small as possible: the
+ * allocation flags are packed into the low bits of the size, which are
+ * always zero because sizes are multiples of MEMFORGE_ALIGNMENT, and the
+ * free-list links live in the user area of free blocks (see
+ * free_block_links_t). The header is 8 bytes in release builds and 16
+ * bytes when MEMFORGE_SAFETY_CHECKS adds the magic number.
  *
  * @struct block_header
  *
- * @var block_header::size
- * Size of the user data area in bytes (does not include header size)
- *
- * @var block_header::next
- * Pointer to the next block in free list or heap chain
- *
- * @var block_header::prev
- * Pointer to the previous block (enables bidirectional traversal for coalescing)
- *
- * @var block_header::is_free
- * Flag indicating whether the block is currently allocated or free
- *
- * @var block_header::is_mapped
- * Flag indicating whether block was allocated via mmap (true) or heap (false)
+ * @var block_header::size_flags
+ * Size of the user data area in bytes (does not include header size),
+ * OR-ed with BLOCK_FLAG_FREE and BLOCK_FLAG_MAPPED
  *
  * @var block_header::magic
  * Magic number for memory corruption detection and validation
  *
  * @note The actual user data starts immediately after this header
+ * @note Access fields through BLOCK_SIZE(), BLOCK_IS_FREE() and friends
  * @see BLOCK_HEADER_SIZE
  */
 typedef struct block_header
 {
-    size_t size;               /**< Size of user data area in bytes */
-    struct block_header *next; /**< Next block in free list or heap */
-    struct block_header *prev; /**< Previous block (for coalescing) */
-    bool is_free;              /**< Whether block is allocated or free */
-    bool is_mapped;            /**< Whether block is mmap'd (not from heap) */
-    unsigned int magic;        /**< Magic number for corruption detection */
+    size_t size_flags; /**< User size in bytes | BLOCK_FLAG_* bits */
+#if MEMFORGE_SAFETY_CHECKS
+    unsigned int magic; /**< Magic number for corruption detection */
+#endif
 } block_header_t;
 
 /**
- * @def BLOCK_HEADER_SIZE
- * @brief Size of block header with proper memory alignment
+ * @def BLOCK_FLAG_FREE
+ * @brief size_flags bit set while the block sits on a free list
+ */
+#define BLOCK_FLAG_FREE ((size_t)1)
+
+/**
+ * @def BLOCK_FLAG_MAPPED
+ * @brief size_flags bit set on blocks that own a private mmap
+ */
+#define BLOCK_FLAG_MAPPED ((size_t)2)
+
+/**
+ * @def BLOCK_FLAG_HUGE
+ * @brief Mapped block placed on a huge page boundary and advised for huge pages
+ */
+#define BLOCK_FLAG_HUGE ((size_t)4)
+
+/**
+ * @def BLOCK_FLAG_MASK
+ * @brief Low size_flags bits available for flags
+ */
+#define BLOCK_FLAG_MASK ((size_t)(MEMFORGE_ALIGNMENT - 1))
+
+/**
+ * @def BLOCK_SIZE(block)
+ * @brief User size of a block with the flag bits stripped
+ */
+#define BLOCK_SIZE(block) ((block)->size_flags & ~BLOCK_FLAG_MASK)
+
+/**
+ * @def BLOCK_IS_FREE(block)
+ * @brief Whether a block is on a free list
+ */
+#define BLOCK_IS_FREE(block) (((block)->size_flags & BLOCK_FLAG_FREE) != 0)
+
+/**
+ * @def BLOCK_IS_MAPPED(block)
+ * @brief Whether a block was allocated with its own mmap
+ */
+#define BLOCK_IS_MAPPED(block) (((block)->size_flags & BLOCK_FLAG_MAPPED) != 0)
+
+/**
+ * @def BLOCK_IS_HUGE
+ * @brief Whether a mapped block is huge-page eligible
+ */
+#define BLOCK_IS_HUGE(block) (((block)->size_flags & BLOCK_FLAG_HUGE) != 0)
+
+/**
+ * @def BLOCK_SET_SIZE(block, size)
+ * @brief Changes a block's size while keeping its flags
+ */
+#define BLOCK_SET_SIZE(block, size) ((block)->size_flags = (size) | ((block)->size_flags & BLOCK_FLAG_MASK))
+
+/**
+ * @def BLOCK_SET_FREE(block)
+ * @brief Marks a block as free
+ */
+#define BLOCK_SET_FREE(block) ((block)->size_flags |= BLOCK_FLAG_FREE)
+
+/**
+ * @def BLOCK_SET_USED(block)
+ * @brief Marks a block as allocated
+ */
+#define BLOCK_SET_USED(block) ((block)->size_flags &= ~BLOCK_FLAG_FREE)
+
+/**
+ * @def BLOCK_SET_MAGIC(block, value)
+ * @brief Stores a magic number (no-op without MEMFORGE_SAFETY_CHECKS)
+ */
+#if MEMFORGE_SAFETY_CHECKS
+#define BLOCK_SET_MAGIC(block, value) ((block)->magic = (value))
+#else
+#define BLOCK_SET_MAGIC(block, value) ((void)(block))
+#endif
+
+/**
+ * @brief Free-list links stored in the user area of a free block
+ *
+ * Allocated blocks do not need list links, so they are kept out of the
+ * header and overlaid on the first bytes of the (unused) user area while
+ * the block is free. MEMFORGE_MIN_ALLOC_SIZE guarantees the room.
+ *
+ * @struct free_block_links
+ *
+ * @var free_block_links::next
+ * Next free block in the same size class list
+ *
+ * @var free_block_links::prev
+ * Previous free block in the same size class list
+ *
+ * @see BLOCK_LINKS()
+ */
+typedef struct free_block_links
+{
+    struct block_header *next; /**< Next block in free list */
+    struct block_header *prev; /**< Previous block in free list */
+} free_block_links_t;
+
+/**
+ * @def BLOCK_HEADER_SIZE
+ * @brief Size of block header with proper memory alignment
+ *
+ * Calculates the actual size of block_header_t including alignment padding.
+ * This ensures all block headers are properly aligned for performance and
+ * architecture requirements.
+ *
+ * @see MEMFORGE_ALIGN
+ * @see block_header_t
+ */
+#define BLOCK_HEADER_SIZE MEMFORGE_ALIGN(sizeof(block_header_t))
+
+/**
+ * @def BLOCK_LINKS(block)
+ * @brief Free-list links of a free block
+ */
+#define BLOCK_LINKS(block) ((free_block_links_t *)BLOCK_TO_PTR(block))
+
+/**
+ * @def BLOCK_TRACKS_PURGE(block)
+ * @brief Whether a free block is large enough to carry a purge stamp
+ */
+#define BLOCK_TRACKS_PURGE(block) (BLOCK_SIZE(block) >= memforge_config.page_size)
+
+/**
+ * @def BLOCK_PURGE_STAMP(block)
+ * @brief Time (ns) a tracked free block last got dirty pages, 0 once purged
+ *
+ * Stored right after the free-list links of blocks that satisfy
+ * BLOCK_TRACKS_PURGE().
+ */
+#define BLOCK_PURGE_STAMP(block) (*(uint64_t *)((char *)BLOCK_TO_PTR(block) + sizeof(free_block_links_t)))
+
+/**
+ * @def FREE_BLOCK_METADATA_SIZE
+ * @brief Bytes at the start of a free block's user area the allocator writes
+ */
+#define FREE_BLOCK_METADATA_SIZE (sizeof(free_block_links_t) + sizeof(uint64_t))
+
+/**
+ * @def BLOCK_TO_PTR(block)
+ * @brief Converts a block header to the user pointer that follows it
+ */
+#define BLOCK_TO_PTR(block) ((void *)((char *)(block) + BLOCK_HEADER_SIZE))
+
+/**
+ * @def PTR_TO_BLOCK(ptr)
+ * @brief Converts a user pointer back to its block header
+ */
+#define PTR_TO_BLOCK(ptr) ((block_header_t *)((char *)(ptr) - BLOCK_HEADER_SIZE))
+
+/**
+ * @def BLOCK_NEXT_PHYSICAL(block)
+ * @brief Returns the block that physically follows block in its segment
+ *
+ * @note Only meaningful for heap blocks; every segment ends with a
+ *       zero-sized, allocated fencepost so the walk never leaves the segment
+ */
+#define BLOCK_NEXT_PHYSICAL(block) ((block_header_t *)((char *)(block) + BLOCK_HEADER_SIZE + BLOCK_SIZE(block)))
+
+/**
+ * @brief What a heap segment is carved into
+ *
+ * @see heap_segment_t
+ */
+typedef enum heap_segment_kinds
+{
+    HEAP_SEGMENT_BLOCKS = 0, /**< Variable-sized blocks with block_header_t */
+    HEAP_SEGMENT_SLAB        /**< Fixed-size slab runs without per-object headers */
+} heap_segment_kind_t;
+
+/**
+ * @brief Heap segment tracking structure
+ *
+ * Tracks contiguous regions of memory obtained from the operating system.
+ * Each segment represents one chunk of memory that has been added to the
+ * heap, either via sbrk() or mmap().
+ *
+ * @struct heap_segment
+ *
+ * @var heap_segment::base
+ * Base address of the memory segment
+ *
+ * @var heap_segment::size
+ * Total size of the segment in bytes
+ *
+ * @var heap_segment::next
+ * Pointer to the next segment in the linked list
+ *
+ * @var heap_segment::arena
+ * Arena whose free lists manage the blocks of this segment
+ *
+ * @var heap_segment::kind
+ * Whether the segment holds header blocks or slab runs
+ *
+ * @var heap_segment::huge_pages
+ * Whether the mapping was advised for (or backed by) huge pages
+ *
+ * @var heap_segment::zero_start
+ * Start of the part of a block segment never handed out (or purged since):
+ * past it only the header and FREE_BLOCK_METADATA_SIZE bytes of a free
+ * block were ever written, and every other byte is zero
+ *
+ * @note Segments are managed as a linked list for easy traversal
+ * @note The tracker lives in-band at the base of the segment it describes
+ */
+typedef struct heap_segment
+{
+    void *base;                   /**< Base address of the memory segment */
+    size_t size;                  /**< Total size of the segment in bytes */
+    struct heap_segment *next;    /**< Next segment in linked list */
+    struct memforge_arena *arena; /**< Arena that owns this segment */
+    heap_segment_kind_t kind;     /**< Block heap or slab runs */
+    bool huge_pages;              /**< Huge-page eligible */
+    char *zero_start;             /**< Never handed out from here on */
+} heap_segment_t;
+
+/**
+ * @def HEAP_SEGMENT_OVERHEAD
+ * @brief Bytes at the start of each segment reserved for its tracker
+ */
+#define HEAP_SEGMENT_OVERHEAD MEMFORGE_ALIGN(sizeof(heap_segment_t))
+
+/**
+ * @def HEAP_SEGMENT_CAPACITY
+ * @brief Largest user size a single heap block can have
+ *
+ * A segment holds its tracker, one block header and the trailing fencepost
+ * header; requests larger than this must be served by mmap.
+ */
+#define HEAP_SEGMENT_CAPACITY (MEMFORGE_HEAP_SEGMENT_SIZE - HEAP_SEGMENT_OVERHEAD - 2 * BLOCK_HEADER_SIZE)
+
+/**
+ * @def HEAP_SEGMENT_OF(ptr)
+ * @brief Finds the segment containing a heap block or user pointer
+ *
+ * Segments are MEMFORGE_HEAP_SEGMENT_SIZE-aligned and store their tracker
+ * at the base, so masking the address is enough.
+ *
+ * @warning Must not be used on mmap'd blocks (block_header_t::is_mapped);
+ *          use segment_map_lookup() when the pointer's origin is unknown
+ */
+#define HEAP_SEGMENT_OF(ptr) ((heap_segment_t *)((uintptr_t)(ptr) & ~(uintptr_t)(MEMFORGE_HEAP_SEGMENT_SIZE - 1)))
+
+/**
+ * @def SLAB_RUN_OBJECTS_MAX
+ * @brief Most objects a single slab run can hold (smallest class)
+ */
+#define SLAB_RUN_OBJECTS_MAX (MEMFORGE_SLAB_RUN_SIZE / MEMFORGE_MIN_ALLOC_SIZE)
+
+/**
+ * @brief Descriptor of one slab run
+ *
+ * A run is a MEMFORGE_SLAB_RUN_SIZE chunk of a slab segment holding
+ * objects of a single size class. Objects have no header: everything the
+ * allocator needs to know about them lives here, in the metadata area at
+ * the start of the segment, and is found from an object pointer by
+ * slab_run_of().
+ *
+ * @struct slab_run
+ *
+ * @var slab_run::base
+ * First byte of the run (address of object 0)
+ *
+ * @var slab_run::free_objects
+ * Objects freed back to this run, linked through their first word
+ *
+ * @var slab_run::next
+ * Next run in the arena's partial list for this class, or in the arena's
+ * list of unassigned runs
+ *
+ * @var slab_run::prev
+ * Previous run in the same list
+ *
+ * @var slab_run::object_size
+ * Size of every object in the run
+ *
+ * @var slab_run::capacity
+ * Number of objects that fit in the run
+ *
+ * @var slab_run::carved
+ * Objects handed out at least once; the rest of the run is untouched
+ *
+ * @var slab_run::used
+ * Objects currently allocated (including those parked in thread caches)
+ *
+ * @var slab_run::size_class
+ * Index into memforge_size_classes served by this run
+ *
+ * @var slab_run::live
+ * Allocation bitmap used to catch double and invalid frees
+ */
+typedef struct slab_run
+{
+    char *base;               /**< Start of the run's object area */
+    void *free_objects;       /**< Freed objects (intrusive list) */
+    struct slab_run *next;    /**< Next run in partial/unassigned list */
+    struct slab_run *prev;    /**< Previous run in the same list */
+    unsigned int object_size; /**< Object size in bytes */
+    unsigned short capacity;  /**< Objects per run */
+    unsigned short carved;    /**< Objects carved so far */
+    unsigned short used;      /**< Objects currently allocated */
+    unsigned char size_class; /**< Size class served */
+#if MEMFORGE_SAFETY_CHECKS
+    uint64_t live[SLAB_RUN_OBJECTS_MAX / 64]; /**< Allocated-object bitmap */
+#endif
+} slab_run_t;
+
+/**
+ * @brief Layout of the metadata area at the base of a slab segment
+ *
+ * The common segment tracker comes first so HEAP_SEGMENT_OF() works for
+ * both kinds of segment, followed by one descriptor per run. Runs that
+ * overlap the metadata area itself are never handed out.
+ *
+ * @struct slab_segment
+ *
+ * @var slab_segment::segment
+ * Common segment tracker (kind == HEAP_SEGMENT_SLAB)
+ *
+ * @var slab_segment::runs
+ * Descriptor of run i, which starts at base + i * MEMFORGE_SLAB_RUN_SIZE
+ */
+typedef struct slab_segment
+{
+    heap_segment_t segment;                                               /**< Common tracker */
+    slab_run_t runs[MEMFORGE_HEAP_SEGMENT_SIZE / MEMFORGE_SLAB_RUN_SIZE]; /**< Run descriptors */
+} slab_segment_t;
+
+/**
+ * @brief Link stored in the user area of a parked block
+ *
+ * While a freed block or slab object sits in a thread cache or in an
+ * arena's remote-free queue, its first word links it to the next entry.
+ */
+typedef struct thread_cache_entry
+{
+    struct thread_cache_entry *next; /**< Next parked block */
+} thread_cache_entry_t;
+
+/**
+ * @brief Memory arena for thread-local allocation
+ *
+ * Arenas provide isolated memory pools that can be used by different threads
+ * to reduce contention. Each arena maintains its own free lists and heap
+ * segments, enabling parallel allocation operations.
+ *
+ * @struct memforge_arena
+ *
+ * @var memforge_arena::lock
+ * Mutex for thread-safe access to this arena
+ *
+ * @var memforge_arena::free_lists
+ * Array of segregated free lists organized by size class
+ *
+ * @var memforge_arena::heap_segments
+ * Linked list of heap segments owned by this arena
+ *
+ * @var memforge_arena::slab_runs
+ * Per size class list of slab runs that still have free objects
+ *
+ * @var memforge_arena::slab_free_runs
+ * Slab runs not currently assigned to any size class
+ *
+ * @var memforge_arena::allocated
+ * Total bytes allocated through this arena (statistics)
+ *
+ * @var memforge_arena::freed
+ * Total bytes freed through this arena (statistics)
+ *
+ * @var memforge_arena::live_blocks
+ * Objects and blocks currently allocated from this arena, so that
+ * memforge_arena_destroy() can account for the ones it frees implicitly
+ *
+ * @var memforge_arena::remote_frees
+ * Lock-free MPSC queue of objects freed by threads using other arenas;
+ * pushed without the lock and drained in bulk under it
+ *
+ * @var memforge_arena::lock_acquisitions
+ * Times the lock was taken (updated under the lock)
+ *
+ * @var memforge_arena::lock_contentions
+ * Lock attempts that found the arena busy (updated atomically)
+ *
+ * @var memforge_arena::pool_next
+ * Next idle arena in the per-thread arena pool
+ *
+ * @var memforge_arena::all_next
+ * Next arena in the list of every per-thread arena
+ *
+ * @var memforge_arena::user_owned
+ * Created by memforge_arena_new(); its blocks bypass thread and per-CPU
+ * caches so that memforge_arena_destroy() cannot leave dangling entries
+ *
+ * @var memforge_arena::purge_due
+ * Time (ns) the oldest dirty free block decays, 0 when every tracked free
+ * block is clean (see heap_purge())
+ *
+ * @note In single-threaded mode, only the main arena is used
+ * @see MEMFORGE_SIZE_CLASS_COUNT
+ */
+typedef struct memforge_arena
+{
+    pthread_mutex_t lock;                                  /**< Arena-specific lock */
+    block_header_t *free_lists[MEMFORGE_SIZE_CLASS_COUNT]; /**< Segregated free lists */
+    heap_segment_t *heap_segments;                         /**< Heap segments owned by this arena */
+    slab_run_t *slab_runs[MEMFORGE_SIZE_CLASS_COUNT];      /**< Partial slab runs per class */
+    slab_run_t *slab_free_runs;                            /**< Unassigned slab runs */
+    size_t allocated;                                      /**< Bytes allocated in this arena */
+    size_t freed;                                          /**< Bytes freed in this arena */
+    size_t live_blocks;                                    /**< Blocks currently allocated */
+    _Atomic(thread_cache_entry_t *) remote_frees;          /**< Frees pushed by other threads */
+    size_t lock_acquisitions;                              /**< Lock acquisitions */
+    atomic_size_t lock_contentions;                        /**< Acquisitions that had to wait */
+    struct memforge_arena *pool_next;                      /**< Next pooled per-thread arena */
+    struct memforge_arena *all_next;                       /**< Next per-thread arena */
+    bool user_owned;                                       /**< Caller-managed arena */
+    uint64_t purge_due;                                    /**< Next purge deadline */
+} memforge_arena_t;
+
+/**
+ * @brief Per-thread cache of recently freed blocks
+ *
+ * Each thread keeps a small LIFO of freed blocks per size class. A malloc
+ * that hits the cache and a free that fits in it touch neither an arena
+ * lock nor an atomic. Cached blocks stay marked as allocated in their
+ * arena and are returned to it in batches when a class overflows or the
+ * thread exits.
+ *
+ * @struct thread_cache
+ *
+ * @var thread_cache::bins
+ * Singly linked LIFO of cached blocks per size class
+ *
+ * @var thread_cache::counts
+ * Number of blocks currently held in each bin
+ *
+ * @var thread_cache::registered
+ * Whether the thread-exit destructor has been armed for this thread
+ *
+ * @see MEMFORGE_THREAD_CACHE_SIZE
+ */
+typedef struct thread_cache
+{
+    thread_cache_entry_t *bins[MEMFORGE_SIZE_CLASS_COUNT]; /**< Cached blocks per class */
+    size_t counts[MEMFORGE_SIZE_CLASS_COUNT];              /**< Blocks held per class */
+    bool registered;                                       /**< Exit destructor armed */
+} thread_cache_t;
+
+/**
+ * @def THREAD_CACHE_ACTIVE()
+ * @brief Whether freed objects are cached at all, per thread or per CPU
+ *
+ * The per-CPU caches replace the thread-local bins rather than sitting on
+ * top of them, so either option alone enables caching.
+ */
+#define THREAD_CACHE_ACTIVE() (memforge_config.thread_cache_enabled || memforge_config.cpu_cache_enabled)
+
+/**
+ * @brief One size class of a per-CPU cache
+ *
+ * A bounded stack of freed blocks. Only the thread currently running on
+ * the CPU touches it, inside an rseq critical section whose last store to
+ * count commits the push or pop.
+ *
+ * @struct cpu_cache_bin
+ *
+ * @var cpu_cache_bin::count
+ * Number of valid entries in slots
+ *
+ * @var cpu_cache_bin::slots
+ * User pointers of the cached blocks, most recent last
+ */
+typedef struct cpu_cache_bin
+{
+    size_t count;                          /**< Blocks held */
+    void *slots[MEMFORGE_CPU_CACHE_SIZE];  /**< Cached blocks */
+} cpu_cache_bin_t;
+
+/**
+ * @brief Cache of recently freed blocks for one logical CPU
+ *
+ * @struct cpu_cache
+ *
+ * @var cpu_cache::bins
+ * One bin per size class
+ *
+ * @see MEMFORGE_CPU_CACHE_SIZE
+ */
+typedef struct cpu_cache
+{
+    cpu_cache_bin_t bins[MEMFORGE_SIZE_CLASS_COUNT]; /**< Bins per class */
+} cpu_cache_t;
+
+/**
+ * @brief Bookkeeping stored at the start of a cached extent
+ *
+ * A freed mapped block is parked whole; its first bytes are reused to
+ * link it into its size bucket and into the age list that drives decay.
+ *
+ * @struct extent_node
+ *
+ * @var extent_node::size
+ * Size of the mapping
+ *
+ * @var extent_node::cached_at
+ * Monotonic time (ns) the extent was parked
+ *
+ * @var extent_node::huge
+ * Whether the mapping is huge-page eligible
+ *
+ * @var extent_node::next
+ * Next extent in the same size bucket
+ *
+ * @var extent_node::prev
+ * Previous extent in the same size bucket
+ *
+ * @var extent_node::older
+ * Next extent towards the oldest one
+ *
+ * @var extent_node::newer
+ * Next extent towards the newest one
+ */
+typedef struct extent_node
+{
+    size_t size;                 /**< Mapped bytes */
+    uint64_t cached_at;          /**< Time parked */
+    bool huge;                   /**< Huge-page eligible */
+    struct extent_node *next;    /**< Next in bucket */
+    struct extent_node *prev;    /**< Previous in bucket */
+    struct extent_node *older;   /**< Older neighbour */
+    struct extent_node *newer;   /**< Newer neighbour */
+} extent_node_t;
+
+/**
+ * @brief Header at the start of every typed object cache slab
+ *
+ * Objects keep their constructed contents while free, so the free list is
+ * a stack of object indexes kept here rather than links stored in the
+ * objects.
+ *
+ * @struct cache_slab
+ *
+ * @var cache_slab::cache
+ * Owning cache
+ *
+ * @var cache_slab::next
+ * Next slab in the cache's partial or full list
+ *
+ * @var cache_slab::prev
+ * Previous slab in the same list
+ *
+ * @var cache_slab::carved
+ * Objects constructed so far; the rest of the slab is untouched
+ *
+ * @var cache_slab::free_count
+ * Entries in free_objects
+ *
+ * @var cache_slab::free_objects
+ * Indexes of freed (still constructed) objects, most recent last
+ */
+typedef struct cache_slab
+{
+    struct memforge_cache *cache; /**< Owning cache */
+    struct cache_slab *next;      /**< Next slab in its list */
+    struct cache_slab *prev;      /**< Previous slab in its list */
+    unsigned int carved;          /**< Objects constructed */
+    unsigned int free_count;      /**< Freed objects */
+    unsigned int free_objects[];  /**< Free object indexes */
+} cache_slab_t;
+
+/**
+ * @brief Typed object cache
+ *
+ * Every slab has the same layout: the header, then capacity objects of
+ * stride bytes starting at objects_offset. Each slab is on the partial
+ * list (objects available), the full list, or is the one fully free slab
+ * kept aside in empty; further fully free slabs are released.
+ *
+ * @struct memforge_cache
+ *
+ * @var memforge_cache::lock
+ * Protects the slabs and counters
+ *
+ * @var memforge_cache::name
+ * Name reported in statistics
+ *
+ * @var memforge_cache::stride
+ * Object size rounded up to the alignment
+ *
+ * @var memforge_cache::slab_size
+ * Size and alignment of each slab
+ *
+ * @var memforge_cache::objects_offset
+ * Offset of the first object within a slab
+ *
+ * @var memforge_cache::capacity
+ * Objects per slab
+ *
+ * @var memforge_cache::ctor
+ * Runs when an object is first carved
+ *
+ * @var memforge_cache::dtor
+ * Runs on every carved object when its slab is released
+ *
+ * @var memforge_cache::partial
+ * Slabs with objects available
+ *
+ * @var memforge_cache::full
+ * Slabs with every object allocated
+ *
+ * @var memforge_cache::empty
+ * A fully free slab kept to absorb alloc/free oscillation
+ *
+ * @var memforge_cache::slab_count
+ * Slabs currently mapped
+ *
+ * @var memforge_cache::objects_in_use
+ * Objects currently allocated
+ *
+ * @var memforge_cache::objects_cached
+ * Free objects in constructed state
+ *
+ * @var memforge_cache::next
+ * Next cache in the list of live caches
+ */
+struct memforge_cache
+{
+    pthread_mutex_t lock;                 /**< Cache lock */
+    char name[MEMFORGE_CACHE_NAME_MAX];   /**< Cache name */
+    size_t stride;                        /**< Bytes per object */
+    size_t slab_size;                     /**< Bytes per slab */
+    size_t objects_offset;                /**< First object offset */
+    unsigned int capacity;                /**< Objects per slab */
+    memforge_cache_fn_t ctor;             /**< Constructor */
+    memforge_cache_fn_t dtor;             /**< Destructor */
+    cache_slab_t *partial;                /**< Slabs with free objects */
+    cache_slab_t *full;                   /**< Slabs without free objects */
+    cache_slab_t *empty;                  /**< Spare fully free slab */
+    size_t slab_count;                    /**< Mapped slabs */
+    size_t objects_in_use;                /**< Allocated objects */
+    size_t objects_cached;                /**< Constructed free objects */
+    struct memforge_cache *next;          /**< Next live cache */
+};
+
+/**
+ * @brief Header at the start of every chunk of a region
+ *
+ * @struct region_chunk
+ *
+ * @var region_chunk::next
+ * Next chunk; chunks after the one being filled are spares kept by
+ * rollback and reset
+ *
+ * @var region_chunk::size
+ * Size of the mapping, header included
+ */
+typedef struct region_chunk
+{
+    struct region_chunk *next; /**< Next chunk */
+    size_t size;               /**< Mapped bytes */
+} region_chunk_t;
+
+/**
+ * @def REGION_CHUNK_OVERHEAD
+ * @brief Bytes at the start of a chunk taken by its header
+ */
+#define REGION_CHUNK_OVERHEAD MEMFORGE_ALIGN(sizeof(region_chunk_t))
+
+/**
+ * @brief Bump-pointer region
+ *
+ * Lives in its first chunk, right after the chunk header. Chunks form a
+ * list in the order they are filled; top and limit bound the free part of
+ * the current one.
+ *
+ * @struct memforge_region
+ *
+ * @var memforge_region::first
+ * First chunk, which also holds this structure
+ *
+ * @var memforge_region::current
+ * Chunk allocations are carved from
+ *
+ * @var memforge_region::top
+ * Next free byte in current
+ *
+ * @var memforge_region::limit
+ * End of current
+ *
+ * @var memforge_region::chunk_size
+ * Size of regular chunks
+ */
+struct memforge_region
+{
+    region_chunk_t *first;   /**< First chunk */
+    region_chunk_t *current; /**< Chunk being filled */
+    char *top;               /**< Bump pointer */
+    char *limit;             /**< End of the current chunk */
+    size_t chunk_size;       /**< Regular chunk size */
+};
+
+/**
+ * @brief One thread's share of the allocator statistics
+ *
+ * Every counter is written only by the thread that owns the shard, so
+ * updates are plain relaxed stores on a cache line no other thread
+ * writes. memforge_get_stats() sums all shards. Shards are never freed:
+ * when a thread exits its shard goes to a pool for the next thread, with
+ * its counters intact.
+ *
+ * @struct stats_shard
+ *
+ * @var stats_shard::counters
+ * Counters contributed by the owning threads; current_usage may wrap
+ * below zero in one shard when blocks are freed by another thread
+ *
+ * @var stats_shard::next
+ * Next shard in the list of every shard
+ *
+ * @var stats_shard::pool_next
+ * Next shard released by an exited thread
+ */
+typedef struct stats_shard
+{
+    memforge_stats_t counters;     /**< This shard's counters */
+    struct stats_shard *next;      /**< Next shard */
+    struct stats_shard *pool_next; /**< Next unowned shard */
+} stats_shard_t;
+
+// ============================================================================
+// GLOBAL STATE DECLARATIONS
+// ============================================================================
+
+/**
+ * @var memforge_config_t memforge_config
+ * @brief Global allocator configuration settings
+ *
+ * Stores runtime configuration parameters including page size, allocation
+ * strategy, thread safety settings, and debugging options.
+ *
+ * @see memforge_config_t
+ */
+extern memforge_config_t memforge_config;
+
+/**
+ * @var stats_shard_t* stats_thread_shard
+ * @brief The calling thread's statistics shard (NULL until its first update)
+ *
+ * @see STATS_ADD()
+ */
+extern _Thread_local stats_shard_t *stats_thread_shard;
+
+#if MEMFORGE_STATS
+/**
+ * @def STATS_ADD
+ * @brief Adds amount to a counter of the calling thread's shard
+ *
+ * field names a memforge_stats_t member, array elements included. The
+ * update is dropped if no shard could be mapped for the thread.
+ */
+#define STATS_ADD(field, amount)                                                        \
+    do                                                                                  \
+    {                                                                                   \
+        stats_shard_t *shard_ = stats_thread_shard;                                     \
+        if (shard_ == NULL)                                                             \
+        {                                                                               \
+            shard_ = stats_shard_acquire();                                             \
+        }                                                                               \
+        if (shard_ != NULL)                                                             \
+        {                                                                               \
+            size_t *counter_ = &shard_->counters.field;                                 \
+            __atomic_store_n(counter_, *counter_ + (size_t)(amount), __ATOMIC_RELAXED); \
+        }                                                                               \
+    } while (0)
+#else
+#define STATS_ADD(field, amount) ((void)(amount))
+#endif
+
+/**
+ * @def STATS_SUB
+ * @brief Subtracts amount from a counter of the calling thread's shard
+ */
+#define STATS_SUB(field, amount) STATS_ADD(field, -(size_t)(amount))
+
+/**
+ * @var memforge_arena_t* memforge_main_arena
+ * @brief Primary memory arena for single-threaded operations
+ *
+ * The main arena handles allocations when thread safety is disabled or
+ * serves as fallback when thread-specific arenas are unavailable.
+ * Always exists when the allocator is initialized.
+ */
+extern memforge_arena_t *memforge_main_arena;
+
+/**
+ * @var memforge_arena_t** memforge_arenas
+ * @brief Array of memory arenas for multi-threaded operation
+ *
+ * In thread-safe mode, multiple arenas are created to reduce contention.
+ * Each thread can be assigned to a specific arena to enable parallel
+ * allocation operations without locking.
+ *
+ * @note Array size is determined by memforge_config.arena_count
+ */
+extern memforge_arena_t **memforge_arenas;
+
+/**
+ * @var atomic_bool memforge_initialized
+ * @brief Initialization state flag
+ *
+ * Indicates whether the allocator has been successfully initialized.
+ * Prevents double-initialization and ensures proper cleanup sequence.
+ *
+ * @note The allocation fast path never reads it; see memforge_init()
+ */
+extern atomic_bool memforge_initialized;
+
+/**
+ * @var size_t memforge_size_classes[MEMFORGE_SIZE_CLASS_COUNT]
+ * @brief Size classes for segregated free lists
+ *
+ * Array of size boundaries used to categorize allocations into different
+ * free lists. This enables faster allocation by reducing search space.
+ *
+ * @see MEMFORGE_SIZE_CLASS_COUNT
+ * @see get_size_class()
+ */
+extern size_t memforge_size_classes[MEMFORGE_SIZE_CLASS_COUNT];
+
+// ============================================================================
+// INTERNAL FUNCTION DECLARATIONS
+// ============================================================================
+
+// Initialization functions
+/**
+ * @brief Initializes default configuration values
+ *
+ * Sets up default allocator configuration based on system properties
+ * and compile-time defaults. Called automatically during allocator
+ * initialization.
+ *
+ * @return int 0 on success, -1 on failure
+ *
+ * @retval 0 Configuration successfully initialized
+ * @retval -1 System property detection failed
+ *
+ * @note Called by memforge_init() during allocator startup
+ * @see memforge_init()
+ */
+int memforge_init_default_config(void);
+
+/**
+ * @brief Initializes memory arenas for allocation
+ *
+ * Creates and initializes the arena system used for memory allocation.
+ * Allocates the arena array and creates individual arenas based on
+ * configuration settings.
+ *
+ * @return int 0 on success, -1 on failure
+ *
+ * @retval 0 All arenas successfully created
+ * @retval -1 Arena allocation failed
+ *
+ * @note In thread-safe mode, creates multiple arenas for reduced contention
+ * @see memforge_arena_t
+ */
+int memforge_init_arenas(void);
+
+/**
+ * @brief Builds the size class lookup tables
+ *
+ * Derives the byte-granular and log2-indexed lookup tables used by
+ * get_size_class() from memforge_size_classes, so changing the class
+ * table at build time needs no other code change.
+ *
+ * @note Called by memforge_init() after the classes have been aligned
+ * @see get_size_class()
+ */
+void size_class_init(void);
+
+// System memory management functions
+/**
+ * @brief Allocates memory directly from operating system via mmap
+ *
+ * Requests memory directly from the OS using memory mapping. Used for
+ * large allocations that exceed the mmap threshold or for internal
+ * allocator structures.
+ *
+ * @param[in] size Number of bytes to allocate
+ * @return void* Pointer to allocated memory, or NULL on failure
+ *
+ * @note Memory allocated with this function must be freed with system_free_mmap()
+ * @note Platform-specific implementation (mmap on Unix, VirtualAlloc on Windows)
+ * @see system_free_mmap()
+ */
+void *system_alloc_mmap(size_t size);
+
+/**
+ * @brief Allocates memory from the OS aligned to a power-of-two boundary
+ *
+ * Maps size bytes whose start address is a multiple of alignment. Used for
+ * heap segments so that HEAP_SEGMENT_OF() can locate them by masking.
+ *
+ * @param[in] size Number of bytes to allocate
+ * @param[in] alignment Required alignment (power of two, multiple of page size)
+ * @return void* Aligned pointer to allocated memory, or NULL on failure
+ *
+ * @note Release with system_free_mmap(ptr, size)
+ * @see system_alloc_mmap()
+ */
+void *system_alloc_mmap_aligned(size_t size, size_t alignment);
+
+/**
+ * @brief Maps memory meant to be backed by huge pages
+ *
+ * Honours memforge_config_t::huge_pages: MAP_HUGETLB when requested and
+ * available, otherwise a mapping aligned to at least
+ * MEMFORGE_HUGE_PAGE_SIZE and advised with MADV_HUGEPAGE.
+ *
+ * @param[in] size Bytes to map (a multiple of MEMFORGE_HUGE_PAGE_SIZE for MAP_HUGETLB)
+ * @param[in] alignment Required alignment, power of two
+ * @param[out] huge Whether the mapping is huge-page eligible
+ * @return void* Start of the mapping, or NULL on failure
+ */
+void *system_alloc_mmap_huge(size_t size, size_t alignment, bool *huge);
+
+/**
+ * @brief Advises an existing mapping for transparent huge pages
+ *
+ * @param[in] ptr Start of the range (page aligned)
+ * @param[in] size Bytes to advise
+ * @return bool true if the kernel accepted MADV_HUGEPAGE
+ */
+bool system_advise_huge(void *ptr, size_t size);
+
+/**
+ * @brief Allocates memory via sbrk for heap expansion
+ *
+ * Requests additional memory from the OS to expand the heap. Used for
+ * small to medium allocations that are managed within the allocator's
+ * heap structures.
+ *
+ * @param[in] size Number of bytes to allocate
+ * @return void* Pointer to allocated memory, or NULL on failure
+ *
+ * @note Primarily used on Unix-like systems
+ * @note Windows implementation may use HeapAlloc as alternative
+ */
+void *system_alloc_sbrk(size_t size);
+
+/**
+ * @brief Frees memory allocated with system_alloc_mmap
+ *
+ * Returns memory previously allocated via system_alloc_mmap back to
+ * the operating system.
+ *
+ * @param[in] ptr Pointer to memory to free
+ * @param[in] size Size of the memory region (must match allocation size)
+ *
+ * @note Must only be used with memory from system_alloc_mmap()
+ * @note Platform-specific implementation (munmap on Unix, VirtualFree on Windows)
+ * @see system_alloc_mmap()
+ */
+void system_free_mmap(void *ptr, size_t size);
+
+/**
+ * @brief Resizes a mapping obtained from system_alloc_mmap*
+ *
+ * The contents up to the smaller size are kept without being copied; the
+ * mapping may move.
+ *
+ * @param[in] ptr Start of the mapping
+ * @param[in] old_size Current size of the mapping
+ * @param[in] new_size Wanted size (page multiple)
+ * @return void* New start of the mapping, or NULL on failure (the old
+ *         mapping is then left intact)
+ */
+void *system_remap_mmap(void *ptr, size_t old_size, size_t new_size);
+
+/**
+ * @brief Reads the monotonic clock
+ *
+ * @return uint64_t Nanoseconds since an arbitrary fixed point
+ */
+uint64_t system_time_ns(void);
+
+/**
+ * @brief Releases the physical pages of a range that stays mapped
+ *
+ * The range reads back as zeros when next touched.
+ *
+ * @param[in] ptr Page-aligned start of the range
+ * @param[in] size Page-multiple length of the range
+ * @return int 0 on success, -1 on failure
+ */
+int system_purge_pages(void *ptr, size_t size);
+
+// Heap management functions
+/**
+ * @brief Creates a new heap segment tracker
+ *
+ * Allocates and initializes a heap_segment_t structure to track a
+ * region of memory obtained from the operating system.
+ *
+ * @param[in] base Base address of the memory segment
+ * @param[in] size Size of the memory segment in bytes
+ * @return heap_segment_t* Pointer to new segment, or NULL on failure
+ *
+ * @see heap_segment_destroy()
+ */
+heap_segment_t *heap_segment_create(void *base, size_t size);
+
+/**
+ * @brief Destroys a heap segment and releases its resources
+ *
+ * Frees a heap_segment_t structure and any associated resources.
+ *
+ * @param[in] segment Segment to destroy
+ *
+ * @see heap_segment_create()
+ */
+void heap_segment_destroy(heap_segment_t *segment);
+
+/**
+ * @brief Adds a new heap segment to an arena
+ *
+ * Maps a fresh MEMFORGE_HEAP_SEGMENT_SIZE segment, links it into the
+ * arena and places one free block spanning the whole usable area on the
+ * arena's free lists.
+ *
+ * @param[in] arena Arena to grow (lock must be held)
+ * @return block_header_t* The new free block, or NULL on failure
+ */
+block_header_t *heap_extend(memforge_arena_t *arena);
+
+/**
+ * @brief Maps a segment for an arena and links it in
+ *
+ * The segment is aligned to its size, registered in the segment map and
+ * backed by huge pages as configured. Its contents are left to the caller.
+ *
+ * @param[in] arena Arena to grow (lock must be held)
+ * @param[in] kind What the segment will hold
+ * @return heap_segment_t* The new segment, or NULL on failure
+ */
+heap_segment_t *heap_segment_map(memforge_arena_t *arena, heap_segment_kind_t kind);
+
+/**
+ * @brief Carves a block of at least size bytes out of an arena's heap
+ *
+ * Searches the free lists with the configured strategy, growing the heap
+ * when nothing fits, then splits off any usable remainder.
+ *
+ * @param[in] arena Arena to allocate from (lock must be held)
+ * @param[in] size Aligned user size in bytes
+ * @param[out] zeroed Optional; set when the block comes from memory never
+ *             handed out, whose user area is zero past its first
+ *             FREE_BLOCK_METADATA_SIZE bytes
+ * @return block_header_t* Allocated block, or NULL when out of memory
+ *
+ * @see heap_segment::zero_start
+ */
+block_header_t *heap_alloc_block(memforge_arena_t *arena, size_t size, bool *zeroed);
+
+/**
+ * @brief Carves up to count adjacent blocks of size bytes
+ *
+ * Takes one free block large enough for as many blocks as fit in a
+ * segment and cuts it into consecutive allocated blocks, repeating until
+ * count blocks are carved or memory runs out.
+ *
+ * @param[in] arena Arena to allocate from (lock held)
+ * @param[in] size Size of every block
+ * @param[out] out Receives the user pointers of the carved blocks
+ * @param[in] count Number of blocks wanted
+ * @return size_t Number of blocks carved
+ */
+size_t heap_alloc_blocks(memforge_arena_t *arena, size_t size, void **out, size_t count);
+
+/**
+ * @brief Returns a heap block to its arena's free lists
+ *
+ * Marks the block free, merges it with a following free block and files
+ * it in the matching free list.
+ *
+ * @param[in] arena Owning arena (lock must be held)
+ * @param[in] block Block to release
+ */
+void heap_free_block(memforge_arena_t *arena, block_header_t *block);
+
+/**
+ * @brief Extends an allocated heap block in place
+ *
+ * The free blocks that physically follow are absorbed only when together
+ * they make enough room; the excess is split off again.
+ *
+ * @param[in] arena Owning arena (lock must be held)
+ * @param[in] block Allocated block to grow
+ * @param[in] size Wanted user size
+ * @return bool true if the block now holds at least size bytes
+ */
+bool heap_grow_block(memforge_arena_t *arena, block_header_t *block, size_t size);
+
+/**
+ * @brief Returns the pages of decayed free blocks to the kernel
+ *
+ * Free blocks of at least a page are stamped when they get dirty; once a
+ * stamp is older than memforge_config_t::purge_decay_ms the whole pages
+ * inside the block are released with system_purge_pages() and the block
+ * is marked clean. Does nothing before arena->purge_due unless all is set.
+ *
+ * @param[in] arena Arena to purge (lock must be held)
+ * @param[in] now Current system_time_ns()
+ * @param[in] all Purge every dirty block regardless of its age
+ * @return size_t Bytes released
+ */
+size_t heap_purge(memforge_arena_t *arena, uint64_t now, bool all);
+
+/**
+ * @brief Returns as much of an arena's free heap memory as possible
+ *
+ * Merges adjacent free blocks, unmaps the block segments that hold no
+ * allocation and purges the whole pages of every other dirty free block,
+ * except for up to pad bytes at the end of the arena's newest segments.
+ *
+ * @param[in] arena Arena to trim (lock must be held)
+ * @param[in] pad Free bytes to keep resident at the end of the heap
+ * @return size_t Bytes unmapped or purged
+ *
+ * @see memforge_malloc_trim()
+ */
+size_t heap_trim(memforge_arena_t *arena, size_t pad);
+
+// Size class management
+/**
+ * @brief Maps a size onto the smallest size class that can hold it
+ *
+ * Resolves the class with one probe of the tables built by
+ * size_class_init() instead of scanning memforge_size_classes.
+ *
+ * @param[in] size Requested size in bytes
+ * @return size_t Index into memforge_size_classes, or
+ *         MEMFORGE_SIZE_CLASS_COUNT if size exceeds the largest class
+ */
+size_t get_size_class(size_t size);
+
+/**
+ * @brief Maps a size onto the largest size class it can fully serve
+ *
+ * Used to file free blocks: every block filed under class i is at least
+ * memforge_size_classes[i] bytes.
+ *
+ * @param[in] size Block size in bytes (at least the smallest class)
+ * @return size_t Index into memforge_size_classes
+ */
+size_t get_size_class_floor(size_t size);
+
+// Free list management
+/**
+ * @brief Inserts a free block at the head of its size class list
+ *
+ * @param[in] arena Owning arena (lock must be held)
+ * @param[in] block Free block to insert
+ */
+void free_list_add(memforge_arena_t *arena, block_header_t *block);
+
+/**
+ * @brief Unlinks a free block from its size class list
+ *
+ * @param[in] arena Owning arena (lock must be held)
+ * @param[in] block Free block to remove
+ */
+void free_list_remove(memforge_arena_t *arena, block_header_t *block);
+
+/**
+ * @brief Finds a free block of at least size bytes
+ *
+ * Applies memforge_config.strategy to the segregated free lists. Adjacent
+ * free blocks met during the scan are merged on the fly.
+ *
+ * @param[in] arena Arena to search (lock must be held)
+ * @param[in] size Required user size in bytes
+ * @return block_header_t* Suitable free block, already unlinked from its
+ *         list, or NULL if no block fits
+ */
+block_header_t *free_list_find(memforge_arena_t *arena, size_t size);
+
+
+// Block management
+/**
+ * @brief Splits the tail of a block off into a new free block
+ *
+ * Shrinks block to size bytes when the remainder can hold a header plus
+ * MEMFORGE_MIN_ALLOC_SIZE bytes, and files the remainder as free.
+ *
+ * @param[in] arena Owning arena (lock must be held)
+ * @param[in] block Block being allocated (already off the free lists)
+ * @param[in] size Aligned user size to keep
+ */
+void block_split(memforge_arena_t *arena, block_header_t *block, size_t size);
+
+/**
+ * @brief Absorbs the physically following blocks while they are free
+ *
+ * @param[in] arena Owning arena (lock must be held)
+ * @param[in] block Block to grow; must not be on a free list
+ * @return block_header_t* The grown block
+ */
+block_header_t *block_coalesce(memforge_arena_t *arena, block_header_t *block);
+
+// Arena management functions
+/**
+ * @brief Gets the current thread's assigned arena
+ *
+ * Returns the arena assigned to the current thread for allocation.
+ * Uses thread-local storage to avoid locking on every allocation.
+ *
+ * @return memforge_arena_t* Pointer to current thread's arena
+ *
+ * @note In non-threaded mode, always returns main arena
+ * @note Implements thread-local storage for performance
+ */
+memforge_arena_t *get_current_arena(void);
+
+/**
+ * @brief Creates a new memory arena
+ *
+ * Allocates and initializes a new memory arena with empty free lists
+ * and proper synchronization primitives.
+ *
+ * @return memforge_arena_t* Pointer to new arena, or NULL on failure
+ *
+ * @note Initializes mutex if thread-safe mode is enabled
+ * @see arena_destroy()
+ */
+memforge_arena_t *arena_create(void);
+
+/**
+ * @brief Destroys a memory arena and its resources
+ *
+ * Safely destroys an arena, freeing all associated resources including
+ * heap segments and synchronization primitives.
+ *
+ * @param[in] arena Arena to destroy
+ *
+ * @note Properly cleans up all arena resources
+ * @see arena_create()
+ */
+void arena_destroy(memforge_arena_t *arena);
+
+/**
+ * @brief Forgets the calling thread's arena assignment
+ *
+ * The next get_current_arena() call assigns a fresh arena. Used when the
+ * arenas are torn down by memforge_cleanup().
+ */
+void arena_reset_thread(void);
+
+/**
+ * @brief Returns the number of per-thread arenas created so far
  *
- * Calculates the actual size of block_header_t including alignment padding.
- * This ensures all block headers are properly aligned for performance and
- * architecture requirements.
+ * Arenas of exited threads are pooled, not destroyed, so this is the peak
+ * number of threads that allocated concurrently under
+ * MEMFORGE_ARENA_PER_THREAD.
+ */
+size_t arena_thread_count(void);
+
+/**
+ * @brief Returns a per-thread arena by position
  *
- * @see MEMFORGE_ALIGN
- * @see block_header_t
+ * @param[in] index Position below arena_thread_count()
+ * @return memforge_arena_t* The arena, or NULL if index is out of range
  */
-#define BLOCK_HEADER_SIZE MEMFORGE_ALIGN(sizeof(block_header_t))
+memforge_arena_t *arena_thread_at(size_t index);
 
 /**
- * @brief Heap segment tracking structure
+ * @brief Destroys every per-thread arena, pooled or in use
  *
- * Tracks contiguous regions of memory obtained from the operating system.
- * Each segment represents one chunk of memory that has been added to the
- * heap, either via sbrk() or mmap().
+ * Called by memforge_cleanup() once no other thread allocates.
+ */
+void arena_destroy_thread_arenas(void);
+
+/**
+ * @brief Acquires an arena's lock when thread safety is enabled
  *
- * @struct heap_segment
+ * Counts the acquisition, and a contention event when the lock was busy.
  *
- * @var heap_segment::base
- * Base address of the memory segment
+ * @param[in] arena Arena to lock
+ */
+void arena_lock(memforge_arena_t *arena);
+
+/**
+ * @brief Releases an arena's lock when thread safety is enabled
  *
- * @var heap_segment::size
- * Total size of the segment in bytes
+ * @param[in] arena Arena to unlock
+ */
+void arena_unlock(memforge_arena_t *arena);
+
+/**
+ * @brief Allocates a heap block from an arena
  *
- * @var heap_segment::next
- * Pointer to the next segment in the linked list
+ * Locking wrapper around heap_alloc_block() that also maintains the
+ * arena's byte counters. Under MEMFORGE_ARENA_CONTENTION_AWARE a busy
+ * arena makes the calling thread move to another one, which then serves
+ * the request.
  *
- * @note Segments are managed as a linked list for easy traversal
+ * @param[in] arena Arena to allocate from
+ * @param[in] size Aligned user size in bytes
+ * @param[out] zeroed Optional; see heap_alloc_block()
+ * @return block_header_t* Allocated block, or NULL when out of memory
  */
-typedef struct heap_segment
-{
-    void *base;                /**< Base address of the memory segment */
-    size_t size;               /**< Total size of the segment in bytes */
-    struct heap_segment *next; /**< Next segment in linked list */
-} heap_segment_t;
+block_header_t *arena_malloc(memforge_arena_t *arena, size_t size, bool *zeroed);
 
 /**
- * @brief Memory arena for thread-local allocation
+ * @brief Returns a heap block to the arena that owns it
  *
- * Arenas provide isolated memory pools that can be used by different threads
- * to reduce contention. Each arena maintains its own free lists and heap
- * segments, enabling parallel allocation operations.
+ * The owning arena is found through HEAP_SEGMENT_OF(), so blocks may be
+ * freed from any thread. Blocks of another thread's arena are queued on
+ * its remote-free queue instead of taking its lock.
  *
- * @struct memforge_arena
+ * @param[in] block Heap block to release (never an mmap'd block)
+ */
+void arena_free(block_header_t *block);
+
+/**
+ * @brief Allocates a slab object from an arena
  *
- * @var memforge_arena::lock
- * Mutex for thread-safe access to this arena
+ * Like arena_malloc(), may move the calling thread to a less contended
+ * arena.
  *
- * @var memforge_arena::free_lists
- * Array of segregated free lists organized by size class
+ * @param[in] arena Arena to allocate from
+ * @param[in] size_class Slab size class (<= MEMFORGE_SLAB_MAX_SIZE)
+ * @return void* Object pointer, or NULL when out of memory
+ */
+void *arena_slab_malloc(memforge_arena_t *arena, size_t size_class);
+
+/**
+ * @brief Allocates up to count objects of one class under a single lock
  *
- * @var memforge_arena::heap_segments
- * Linked list of heap segments owned by this arena
+ * Slab classes are taken from the arena's runs, larger classes are carved
+ * as adjacent heap blocks.
  *
- * @var memforge_arena::allocated
- * Total bytes allocated through this arena (statistics)
+ * @param[in] arena Preferred arena
+ * @param[in] size Class size of the objects
+ * @param[in] size_class Index into memforge_size_classes
+ * @param[out] out Receives the user pointers
+ * @param[in] count Number of objects wanted
+ * @return size_t Number of objects allocated
+ */
+size_t arena_malloc_batch(memforge_arena_t *arena, size_t size, size_t size_class, void **out, size_t count);
+
+/**
+ * @brief Returns a slab object to the arena that owns its run
  *
- * @var memforge_arena::freed
- * Total bytes freed through this arena (statistics)
+ * Like arena_free(), objects of another thread's arena are queued on its
+ * remote-free queue.
  *
- * @note In single-threaded mode, only the main arena is used
- * @see MEMFORGE_SIZE_CLASS_COUNT
+ * @param[in] ptr Slab object to release
  */
-typedef struct memforge_arena
-{
-    pthread_mutex_t lock;                                  /**< Arena-specific lock */
-    block_header_t *free_lists[MEMFORGE_SIZE_CLASS_COUNT]; /**< Segregated free lists */
-    heap_segment_t *heap_segments;                         /**< Heap segments owned by this arena */
-    size_t allocated;                                      /**< Bytes allocated in this arena */
-    size_t freed;                                          /**< Bytes freed in this arena */
-} memforge_arena_t;
+void arena_slab_free(void *ptr);
 
-// ============================================================================
-// GLOBAL STATE DECLARATIONS
-// ============================================================================
+/**
+ * @brief Grows a heap block in place under its arena's lock
+ *
+ * @param[in] block Allocated heap block
+ * @param[in] size Wanted user size
+ * @return bool true if the block was grown, false if its neighbours are in use
+ *
+ * @see heap_grow_block()
+ */
+bool arena_grow_block(block_header_t *block, size_t size);
 
 /**
- * @var memforge_config_t memforge_config
- * @brief Global allocator configuration settings
+ * @brief Purges an arena's decayed free pages under its lock
  *
- * Stores runtime configuration parameters including page size, allocation
- * strategy, thread safety settings, and debugging options.
+ * @param[in] arena Arena to purge
+ * @param[in] all Purge every dirty free block regardless of its age
+ * @return size_t Bytes released
  *
- * @see memforge_config_t
+ * @see heap_purge()
  */
-extern memforge_config_t memforge_config;
+size_t arena_purge(memforge_arena_t *arena, bool all);
 
 /**
- * @var memforge_stats_t memforge_stats
- * @brief Global allocation statistics tracker
+ * @brief Trims an arena's heap blocks and slab runs under its lock, after
+ *        draining its remote frees
  *
- * Maintains runtime statistics for monitoring allocator performance
- * including allocation counts, memory usage, and operational metrics.
+ * @param[in] arena Arena to trim
+ * @param[in] pad Free bytes to keep resident at the end of the heap
+ * @return size_t Bytes unmapped or purged
  *
- * @see memforge_stats_t
+ * @see heap_trim()
+ * @see slab_trim()
  */
-extern memforge_stats_t memforge_stats;
+size_t arena_trim(memforge_arena_t *arena, size_t pad);
 
 /**
- * @var memforge_arena_t* memforge_main_arena
- * @brief Primary memory arena for single-threaded operations
+ * @brief Tells whether an arena belongs to another thread
  *
- * The main arena handles allocations when thread safety is disabled or
- * serves as fallback when thread-specific arenas are unavailable.
- * Always exists when the allocator is initialized.
+ * @param[in] arena Arena owning the object being freed
+ * @return true when frees into arena should go through its remote-free queue
  */
-extern memforge_arena_t *memforge_main_arena;
+bool arena_is_remote(const memforge_arena_t *arena);
 
 /**
- * @var memforge_arena_t** memforge_arenas
- * @brief Array of memory arenas for multi-threaded operation
+ * @brief Pushes a chain of freed objects onto an arena's remote-free queue
  *
- * In thread-safe mode, multiple arenas are created to reduce contention.
- * Each thread can be assigned to a specific arena to enable parallel
- * allocation operations without locking.
+ * Lock-free: the whole chain is published with a single compare-and-swap,
+ * and the arena's lock holder returns it to the arena later.
  *
- * @note Array size is determined by memforge_config.arena_count
+ * @param[in] arena Arena owning every object of the chain
+ * @param[in] first First entry of the chain
+ * @param[in] last Last entry of the chain (may equal first)
+ * @param[in] count Number of entries in the chain
  */
-extern memforge_arena_t **memforge_arenas;
+void arena_remote_free(memforge_arena_t *arena, thread_cache_entry_t *first, thread_cache_entry_t *last, size_t count);
 
 /**
- * @var bool memforge_initialized
- * @brief Initialization state flag
+ * @brief Returns one freed object to its arena
  *
- * Indicates whether the allocator has been successfully initialized.
- * Prevents double-initialization and ensures proper cleanup sequence.
+ * Dispatches on the kind of the object's segment and updates the arena's
+ * byte counters. The caller must hold the arena lock.
+ *
+ * @param[in] arena Arena owning the object
+ * @param[in] ptr User pointer of a heap block or slab object
  */
-extern bool memforge_initialized;
+void arena_release_object(memforge_arena_t *arena, void *ptr);
 
 /**
- * @var size_t memforge_size_classes[MEMFORGE_SIZE_CLASS_COUNT]
- * @brief Size classes for segregated free lists
+ * @brief Returns a chain of parked objects to their arenas
  *
- * Array of size boundaries used to categorize allocations into different
- * free lists. This enables faster allocation by reducing search space.
+ * Used to flush thread and per-CPU caches. Runs of entries owned by the
+ * calling thread's arena are freed under one lock acquisition, runs owned
+ * by other arenas are pushed onto their remote-free queues.
  *
- * @see MEMFORGE_SIZE_CLASS_COUNT
- * @see get_size_class()
+ * @param[in] entry First entry of a NULL-terminated chain (may be NULL)
  */
-extern size_t memforge_size_classes[MEMFORGE_SIZE_CLASS_COUNT];
-
-// ============================================================================
-// INTERNAL FUNCTION DECLARATIONS
-// ============================================================================
+void arena_release_chain(thread_cache_entry_t *entry);
 
-// Initialization functions
+// Slab functions
 /**
- * @brief Initializes default configuration values
+ * @brief Allocates one object of a slab size class
  *
- * Sets up default allocator configuration based on system properties
- * and compile-time defaults. Called automatically during allocator
- * initialization.
+ * Pops an object from the first partial run of the class, assigning a
+ * fresh run (and mapping a new slab segment if needed) when none is left.
  *
- * @return int 0 on success, -1 on failure
+ * @param[in] arena Arena to allocate from (lock must be held)
+ * @param[in] size_class Slab size class
+ * @return void* Object pointer, or NULL when out of memory
+ */
+void *slab_alloc_object(memforge_arena_t *arena, size_t size_class);
+
+/**
+ * @brief Returns an object to its run
  *
- * @retval 0 Configuration successfully initialized
- * @retval -1 System property detection failed
+ * Runs that become empty are handed back to the arena's pool of
+ * unassigned runs, except the last partial run of their class.
  *
- * @note Called by memforge_init() during allocator startup
- * @see memforge_init()
+ * @param[in] arena Owning arena (lock must be held)
+ * @param[in] ptr Object to release
+ * @return bool false if ptr is not a live object of its run (double or
+ *         invalid free, only detected with MEMFORGE_SAFETY_CHECKS)
  */
-int memforge_init_default_config(void);
+bool slab_free_object(memforge_arena_t *arena, void *ptr);
 
 /**
- * @brief Initializes memory arenas for allocation
+ * @brief Finds the run descriptor of a slab object
  *
- * Creates and initializes the arena system used for memory allocation.
- * Allocates the arena array and creates individual arenas based on
- * configuration settings.
+ * @param[in] ptr Pointer into a slab segment
+ * @return slab_run_t* Descriptor of the run containing ptr
+ */
+slab_run_t *slab_run_of(const void *ptr);
+
+/**
+ * @brief Returns the memory of an arena's empty slab runs and segments
  *
- * @return int 0 on success, -1 on failure
+ * Unmaps the slab segments that hold no object and purges the pages of
+ * the other empty runs.
  *
- * @retval 0 All arenas successfully created
- * @retval -1 Arena allocation failed
+ * @param[in] arena Arena to trim (lock must be held)
+ * @return size_t Bytes unmapped or purged that may have been resident
  *
- * @note In thread-safe mode, creates multiple arenas for reduced contention
- * @see memforge_arena_t
+ * @see memforge_malloc_trim()
  */
-int memforge_init_arenas(void);
+size_t slab_trim(memforge_arena_t *arena);
 
-// System memory management functions
+// Segment map functions
 /**
- * @brief Allocates memory directly from operating system via mmap
- *
- * Requests memory directly from the OS using memory mapping. Used for
- * large allocations that exceed the mmap threshold or for internal
- * allocator structures.
- *
- * @param[in] size Number of bytes to allocate
- * @return void* Pointer to allocated memory, or NULL on failure
+ * @brief Records a segment in the global segment map
  *
- * @note Memory allocated with this function must be freed with system_free_mmap()
- * @note Platform-specific implementation (mmap on Unix, VirtualAlloc on Windows)
- * @see system_free_mmap()
+ * @param[in] segment Segment to register
+ * @return int 0 on success, -1 if the map could not grow
  */
-void *system_alloc_mmap(size_t size);
+int segment_map_register(heap_segment_t *segment);
 
 /**
- * @brief Allocates memory via sbrk for heap expansion
+ * @brief Removes a segment from the global segment map
  *
- * Requests additional memory from the OS to expand the heap. Used for
- * small to medium allocations that are managed within the allocator's
- * heap structures.
+ * @param[in] segment Segment to unregister
+ */
+void segment_map_unregister(heap_segment_t *segment);
+
+/**
+ * @brief Finds the segment containing an arbitrary pointer
  *
- * @param[in] size Number of bytes to allocate
- * @return void* Pointer to allocated memory, or NULL on failure
+ * Unlike HEAP_SEGMENT_OF(), never dereferences memory that might not be
+ * mapped, so it can classify any pointer passed to memforge_free().
  *
- * @note Primarily used on Unix-like systems
- * @note Windows implementation may use HeapAlloc as alternative
+ * @param[in] ptr Pointer to classify
+ * @return heap_segment_t* Owning segment, or NULL for mmap'd blocks and
+ *         foreign pointers
  */
-void *system_alloc_sbrk(size_t size);
+heap_segment_t *segment_map_lookup(const void *ptr);
 
+// Thread cache functions
 /**
- * @brief Frees memory allocated with system_alloc_mmap
+ * @brief Pops a cached object of the given size class
  *
- * Returns memory previously allocated via system_alloc_mmap back to
- * the operating system.
+ * Served from the calling CPU's cache instead when per-CPU caches are
+ * enabled.
  *
- * @param[in] ptr Pointer to memory to free
- * @param[in] size Size of the memory region (must match allocation size)
+ * @param[in] size_class Index into memforge_size_classes
+ * @return void* User pointer of a cached slab object or heap block, or
+ *         NULL on a miss
  *
- * @note Must only be used with memory from system_alloc_mmap()
- * @note Platform-specific implementation (munmap on Unix, VirtualFree on Windows)
- * @see system_alloc_mmap()
+ * @note Touches only thread-local or rseq-protected per-CPU state
  */
-void system_free_mmap(void *ptr, size_t size);
+void *thread_cache_alloc(size_t size_class);
 
-// Heap management functions
 /**
- * @brief Creates a new heap segment tracker
+ * @brief Parks a freed object in the calling thread's cache
  *
- * Allocates and initializes a heap_segment_t structure to track a
- * region of memory obtained from the operating system.
+ * When the bin is full, the older half of it is first flushed back to
+ * the owning arenas, taking each arena lock once per run of entries.
+ * With per-CPU caches enabled the object goes to the calling CPU's cache
+ * and the thread bins are never used.
  *
- * @param[in] base Base address of the memory segment
- * @param[in] size Size of the memory segment in bytes
- * @return heap_segment_t* Pointer to new segment, or NULL on failure
+ * @param[in] ptr User pointer of a slab object or heap block being freed
+ * @param[in] size_class Size class of the object
+ * @return bool true if the object was cached, false if the caller must
+ *         free it itself (cache disabled, class not cacheable, or
+ *         per-CPU caches enabled but unusable from this thread)
  *
- * @see heap_segment_destroy()
+ * @note Heap blocks are expected to carry MEMFORGE_CACHED_MAGIC while
+ *       cached; the caller sets it
  */
-heap_segment_t *heap_segment_create(void *base, size_t size);
+bool thread_cache_free(void *ptr, size_t size_class);
 
 /**
- * @brief Destroys a heap segment and releases its resources
+ * @brief Returns every block in the calling thread's cache to its arena
  *
- * Frees a heap_segment_t structure and any associated resources.
+ * Called on thread exit and during memforge_cleanup().
+ */
+void thread_cache_flush(void);
+
+// Purge thread functions
+/**
+ * @brief Starts the background thread purging decayed free pages
  *
- * @param[in] segment Segment to destroy
+ * The thread waits on CLOCK_MONOTONIC, so wall clock changes do not delay
+ * it. Nothing is started when memforge_config_t::purge_decay_ms is
+ * SIZE_MAX, since no page ever decays.
  *
- * @see heap_segment_create()
+ * @return int 0 on success (or nothing to do), -1 if the thread could not
+ *         be created
  */
-void heap_segment_destroy(heap_segment_t *segment);
+int purge_thread_start(void);
 
-// Arena management functions
 /**
- * @brief Gets the current thread's assigned arena
+ * @brief Stops and joins the purge thread if it runs
+ */
+void purge_thread_stop(void);
+
+// Extent cache functions
+/**
+ * @brief Takes a cached extent of at least size bytes
+ *
+ * Only extents at most about 1.5 times larger are considered, so reuse
+ * never pins much more memory than asked for.
+ *
+ * @param[in] size Bytes needed (page multiple)
+ * @param[in] huge Whether the request wants huge pages. Huge-page extents
+ *                 only serve such requests; plain extents serve any, so a
+ *                 mapping whose huge page advice failed is still reused
+ * @param[out] extent_size Size of the extent returned
+ * @param[out] extent_huge Whether the extent is huge-page eligible
+ * @return void* Start of the extent, or NULL on a miss
+ */
+void *extent_cache_get(size_t size, bool huge, size_t *extent_size, bool *extent_huge);
+
+/**
+ * @brief Parks a freed mapping for reuse
  *
- * Returns the arena assigned to the current thread for allocation.
- * Uses thread-local storage to avoid locking on every allocation.
+ * @param[in] base Start of the mapping
+ * @param[in] size Size of the mapping
+ * @param[in] huge Whether the mapping is huge-page eligible
+ * @return bool false if the extent is too large to cache; the caller
+ *         releases it with extent_release()
+ */
+bool extent_cache_put(void *base, size_t size, bool huge);
+
+/**
+ * @brief Unmaps an extent and updates the huge page accounting
+ */
+void extent_release(void *base, size_t size, bool huge);
+
+/**
+ * @brief Unmaps every cached extent
  *
- * @return memforge_arena_t* Pointer to current thread's arena
+ * @return size_t Bytes returned to the system
+ */
+size_t extent_cache_flush(void);
+
+// Per-CPU cache functions
+/**
+ * @brief Maps the per-CPU caches
  *
- * @note In non-threaded mode, always returns main arena
- * @note Implements thread-local storage for performance
+ * @return int 0 on success, -1 when rseq is unavailable or mapping failed
  */
-memforge_arena_t *get_current_arena(void);
+int cpu_cache_init(void);
 
 /**
- * @brief Creates a new memory arena
+ * @brief Pops a block from the calling CPU's cache
  *
- * Allocates and initializes a new memory arena with empty free lists
- * and proper synchronization primitives.
+ * @param[in] size_class Size class to allocate
+ * @param[out] ptr Cached block, or NULL when the CPU's bin is empty
+ * @return bool false when the calling thread cannot use per-CPU caches
+ */
+bool cpu_cache_alloc(size_t size_class, void **ptr);
+
+/**
+ * @brief Pushes a freed block onto the calling CPU's cache
  *
- * @return memforge_arena_t* Pointer to new arena, or NULL on failure
+ * @param[in] ptr User pointer of the freed block
+ * @param[in] size_class Size class of the block
+ * @return bool true if the block was cached, false if the caller must free it
+ */
+bool cpu_cache_free(void *ptr, size_t size_class);
+
+/**
+ * @brief Returns the blocks cached for the calling thread's CPU to their arenas
  *
- * @note Initializes mutex if thread-safe mode is enabled
- * @see arena_destroy()
+ * rseq only protects a bin against threads of its own CPU, so the bins of
+ * other CPUs are not touched; they hold at most MEMFORGE_CPU_CACHE_SIZE
+ * blocks per size class each. Stops early if the thread migrates.
  */
-memforge_arena_t *arena_create(void);
+void cpu_cache_drain(void);
 
 /**
- * @brief Destroys a memory arena and its resources
+ * @brief Returns every per-CPU cached block and unmaps the caches
+ */
+void cpu_cache_destroy(void);
+
+// Statistics functions
+/**
+ * @brief Gives the calling thread a statistics shard
  *
- * Safely destroys an arena, freeing all associated resources including
- * heap segments and synchronization primitives.
+ * Reuses a shard released by an exited thread or maps a new one, and arms
+ * the thread-exit destructor that releases it again.
  *
- * @param[in] arena Arena to destroy
+ * @return stats_shard_t* The thread's shard, or NULL if none could be mapped
+ */
+stats_shard_t *stats_shard_acquire(void);
+
+/**
+ * @brief Folds the current usage into the recorded peak
  *
- * @note Properly cleans up all arena resources
- * @see arena_create()
+ * Summing every shard on each allocation would defeat sharding, so the
+ * peak is sampled where usage grows in large steps (new segments, mapped
+ * blocks) and whenever statistics are read.
  */
-void arena_destroy(memforge_arena_t *arena);
+void stats_observe_peak(void);
+
+/**
+ * @brief Zeroes every shard and the recorded peak
+ *
+ * @note Not safe against concurrent allocations; used by memforge_reset()
+ */
+void stats_reset(void);
 
 // Utility functions
 /**
@@ -450,6 +1829,52 @@ bool heap_validate(void);
  */
 int thread_get_id(void);
 
+/**
+ * @brief Returns the calling thread's registered rseq area
+ *
+ * Uses the C library's registration when there is one and registers the
+ * thread otherwise.
+ *
+ * @return void* The thread's struct rseq, or NULL when rseq critical
+ *         sections cannot be used
+ */
+void *rseq_thread_area(void);
+
+/**
+ * @brief Reads the CPU the calling thread is running on
+ *
+ * @param[in] area Area returned by rseq_thread_area()
+ * @return unsigned int Current CPU number (may be stale by the time it is used)
+ */
+unsigned int rseq_current_cpu(void *area);
+
+/**
+ * @brief Pushes ptr onto a per-CPU pointer stack inside an rseq critical section
+ *
+ * @param[in] area Area returned by rseq_thread_area()
+ * @param[in] cpu CPU the stack belongs to
+ * @param[in,out] count Stack depth; the store to it commits the push
+ * @param[in] slots Stack storage
+ * @param[in] capacity Maximum depth
+ * @param[in] ptr Pointer to push
+ * @return int 0 on success, 1 if the stack is full, -1 if the thread was
+ *         preempted or is not running on cpu
+ */
+int rseq_stack_push(void *area, unsigned int cpu, size_t *count, void **slots, size_t capacity, void *ptr);
+
+/**
+ * @brief Pops the top of a per-CPU pointer stack inside an rseq critical section
+ *
+ * @param[in] area Area returned by rseq_thread_area()
+ * @param[in] cpu CPU the stack belongs to
+ * @param[in,out] count Stack depth; the store to it commits the pop
+ * @param[in] slots Stack storage
+ * @param[out] out Popped pointer
+ * @return int 0 on success, 1 if the stack is empty, -1 if the thread was
+ *         preempted or is not running on cpu
+ */
+int rseq_stack_pop(void *area, unsigned int cpu, size_t *count, void **slots, void **out);
+
 #endif
 
 // Old internal private functions
@@ -5,13 +5,268 @@
 
 // Internals: our internal header for data structures and declarations
 #include "../../include/memforge/memforge_internal.h"
-#include "init.c";
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
 
 // ============================================================================
 // PRIVATE HELPER FUNCTIONS
 // ============================================================================
 
-// future helpers
+/**
+ * stats_record_allocation - Accounts for a block handed out to the user
+ */
+static void stats_record_allocation(size_t size)
+{
+    STATS_ADD(total_allocated, size);
+    STATS_ADD(allocation_count, 1);
+    STATS_ADD(current_usage, size);
+}
+
+/**
+ * stats_record_free - Accounts for a block given back by the user
+ */
+static void stats_record_free(size_t size)
+{
+    STATS_ADD(total_freed, size);
+    STATS_ADD(free_count, 1);
+    STATS_SUB(current_usage, size);
+}
+
+/**
+ * stats_record_resize - Accounts for a block resized where it lies
+ * Counted like the free and allocation of a realloc that moves the block
+ */
+static void stats_record_resize(size_t old_size, size_t new_size)
+{
+    stats_record_free(old_size);
+    stats_record_allocation(new_size);
+}
+
+/**
+ * mapped_alloc - Serves a large request with its own mapping
+ * The mapping is rounded to whole pages and the slack is reported as usable.
+ * Blocks spanning a huge page start on a huge page boundary (and are
+ * rounded to whole huge pages for MAP_HUGETLB) unless huge pages are off.
+ * A recently freed mapping of similar size is reused before mapping anew,
+ * and advised again when it lacks the huge pages the request wants;
+ * zeroed tells whether the block is fresh from the kernel, hence all zero
+ */
+static block_header_t *mapped_alloc(size_t size, bool *zeroed)
+{
+    size_t page_size = memforge_config.page_size;
+    if (size > SIZE_MAX - BLOCK_HEADER_SIZE - MEMFORGE_HUGE_PAGE_SIZE)
+    {
+        return NULL;
+    }
+
+    size_t total = (size + BLOCK_HEADER_SIZE + page_size - 1) & ~(page_size - 1);
+    bool want_huge = total >= MEMFORGE_HUGE_PAGE_SIZE && memforge_config.huge_pages != MEMFORGE_HUGE_PAGES_NONE;
+    if (want_huge && memforge_config.huge_pages == MEMFORGE_HUGE_PAGES_HUGETLB)
+    {
+        total = (total + MEMFORGE_HUGE_PAGE_SIZE - 1) & ~(MEMFORGE_HUGE_PAGE_SIZE - 1);
+    }
+
+    bool huge = false;
+    block_header_t *block = extent_cache_get(total, want_huge, &total, &huge);
+    *zeroed = block == NULL;
+    if (block != NULL)
+    {
+        STATS_ADD(mmap_cache_hits, 1); // Still mapped and counted in huge_page_bytes
+        if (want_huge && !huge && system_advise_huge(block, total))
+        {
+            huge = true;
+            STATS_ADD(huge_page_bytes, total & ~(MEMFORGE_HUGE_PAGE_SIZE - 1));
+        }
+    }
+    else
+    {
+        block = want_huge ? system_alloc_mmap_huge(total, MEMFORGE_HUGE_PAGE_SIZE, &huge) : system_alloc_mmap(total);
+        if (block == NULL)
+        {
+            return NULL;
+        }
+
+        if (huge)
+        {
+            STATS_ADD(huge_page_bytes, total & ~(MEMFORGE_HUGE_PAGE_SIZE - 1));
+        }
+        STATS_ADD(mmap_count, 1);
+    }
+
+    block->size_flags = (total - BLOCK_HEADER_SIZE) | BLOCK_FLAG_MAPPED | (huge ? BLOCK_FLAG_HUGE : 0);
+    BLOCK_SET_MAGIC(block, MEMFORGE_MAGIC_NUMBER);
+    return block;
+}
+
+/**
+ * mmap_threshold_adapt - Raises the mmap threshold past a freed mapping
+ * Requests of that size are then served by the heap. The threshold only
+ * grows, stays under its ceiling, and is left alone once fixed or while
+ * it reads 0 (uninitialized)
+ */
+static void mmap_threshold_adapt(size_t total)
+{
+    if (memforge_config.mmap_threshold_fixed || total > memforge_config.mmap_threshold_max)
+    {
+        return;
+    }
+
+    size_t current = __atomic_load_n(&memforge_config.mmap_threshold, __ATOMIC_RELAXED);
+    while (current != 0 && current < total)
+    {
+        if (__atomic_compare_exchange_n(&memforge_config.mmap_threshold, &current, total, true, __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED))
+        {
+            debug_log("mmap threshold raised to %zu bytes", total);
+            return;
+        }
+    }
+}
+
+/**
+ * mapped_free - Parks a block created by mapped_alloc in the extent cache
+ * Mappings too large to cache are unmapped right away
+ */
+static void mapped_free(block_header_t *block)
+{
+    size_t total = BLOCK_SIZE(block) + BLOCK_HEADER_SIZE;
+    bool huge = BLOCK_IS_HUGE(block);
+    mmap_threshold_adapt(total);
+    if (!extent_cache_put(block, total, huge))
+    {
+        extent_release(block, total, huge);
+    }
+}
+
+/**
+ * mapped_realloc - Resizes a block created by mapped_alloc with mremap
+ * The kernel moves page tables instead of the allocator copying bytes.
+ * Returns the block at its possibly new address, or NULL with the block
+ * left untouched
+ */
+static block_header_t *mapped_realloc(block_header_t *block, size_t size)
+{
+    size_t page_size = memforge_config.page_size;
+    if (size > SIZE_MAX - BLOCK_HEADER_SIZE - MEMFORGE_HUGE_PAGE_SIZE)
+    {
+        return NULL;
+    }
+
+    size_t old_total = BLOCK_SIZE(block) + BLOCK_HEADER_SIZE;
+    size_t total = (size + BLOCK_HEADER_SIZE + page_size - 1) & ~(page_size - 1);
+    bool huge = BLOCK_IS_HUGE(block);
+    if (huge && memforge_config.huge_pages == MEMFORGE_HUGE_PAGES_HUGETLB)
+    {
+        total = (total + MEMFORGE_HUGE_PAGE_SIZE - 1) & ~(MEMFORGE_HUGE_PAGE_SIZE - 1); // Resized in whole huge pages
+    }
+
+    if (total == old_total)
+    {
+        return block;
+    }
+
+    block_header_t *moved = system_remap_mmap(block, old_total, total);
+    if (moved == NULL)
+    {
+        return NULL;
+    }
+
+    if (huge)
+    {
+        STATS_SUB(huge_page_bytes, old_total & ~(MEMFORGE_HUGE_PAGE_SIZE - 1));
+        STATS_ADD(huge_page_bytes, total & ~(MEMFORGE_HUGE_PAGE_SIZE - 1));
+    }
+
+    moved->size_flags = (total - BLOCK_HEADER_SIZE) | BLOCK_FLAG_MAPPED | (huge ? BLOCK_FLAG_HUGE : 0);
+    return moved;
+}
+
+/**
+ * cached_size_class - Size class a freed heap block can be cached under
+ * Only blocks whose size is exactly a class size are cached, so a cache hit
+ * never hands out a block smaller than the class promises
+ */
+static size_t cached_size_class(const block_header_t *block)
+{
+    size_t size = BLOCK_SIZE(block);
+    size_t size_class = get_size_class(size);
+    if (size_class < MEMFORGE_SIZE_CLASS_COUNT && memforge_size_classes[size_class] != size)
+    {
+        return MEMFORGE_SIZE_CLASS_COUNT;
+    }
+
+    return size_class;
+}
+
+/**
+ * size_class_round - Rounds an arena-sized request up to its size class
+ * Returns the rounded size and stores the class index (or
+ * MEMFORGE_SIZE_CLASS_COUNT above the largest class) in size_class
+ */
+static size_t size_class_round(size_t size, size_t *size_class)
+{
+    size_t aligned = MEMFORGE_ALIGN(size);
+    *size_class = get_size_class(aligned);
+    if (*size_class < MEMFORGE_SIZE_CLASS_COUNT)
+    {
+        aligned = memforge_size_classes[*size_class];
+    }
+
+    return aligned;
+}
+
+/**
+ * arena_alloc_rounded - Serves a class-rounded request from arena itself
+ * Small classes come from slab runs, larger ones from heap blocks
+ */
+static void *arena_alloc_rounded(memforge_arena_t *arena, size_t aligned, size_t size_class)
+{
+    if (aligned <= MEMFORGE_SLAB_MAX_SIZE)
+    {
+        // Small classes: header-less object from a slab run
+        return arena_slab_malloc(arena, size_class);
+    }
+
+    block_header_t *block = arena_malloc(arena, aligned, NULL);
+    return block != NULL ? BLOCK_TO_PTR(block) : NULL;
+}
+
+/**
+ * stats_record_class - Accounts for an allocation in its size class
+ */
+static void stats_record_class(size_t size_class, size_t requested, size_t usable)
+{
+    if (size_class < MEMFORGE_SIZE_CLASS_COUNT)
+    {
+        STATS_ADD(class_requested[size_class], requested);
+        STATS_ADD(class_allocated[size_class], usable);
+    }
+}
+
+#if MEMFORGE_SAFETY_CHECKS
+/**
+ * free_size_matches - Checks a size passed to memforge_free_sized()
+ * Slab objects must come back with a size of their own class; other blocks
+ * with a size that fits them and is too large for a slab class
+ */
+static bool free_size_matches(void *ptr, size_t size)
+{
+    size_t size_class;
+    size_t aligned = size_class_round(size == 0 ? 1 : size, &size_class);
+    size_t usable = memforge_usable_size(ptr);
+
+    heap_segment_t *segment = segment_map_lookup(ptr);
+    if (segment != NULL && segment->kind == HEAP_SEGMENT_SLAB)
+    {
+        return aligned == usable;
+    }
+
+    return usable != 0 && size <= usable &&
+           (aligned > MEMFORGE_SLAB_MAX_SIZE || size >= memforge_config.mmap_threshold);
+}
+#endif
 
 // ============================================================================
 // PUBLIC ALLOCATOR API IMPLEMENTATION
@@ -24,21 +279,87 @@
  */
 void *memforge_malloc(size_t size)
 {
-    // Auto-initialize allocator on first use if not already done
-    if (!memforge_initialized)
+    // glibc behaviour: malloc(0) returns a unique pointer (not NULL)
+    if (size == 0)
+    {
+        size = 1; // Allocate minimum amount
+    }
+
+    void *ptr = NULL;
+    size_t usable = 0;
+
+    // Reads 0 until initialization completes, so the first call lands in the large branch
+    size_t mmap_threshold = __atomic_load_n(&memforge_config.mmap_threshold, __ATOMIC_ACQUIRE);
+
+    if (size >= mmap_threshold || size > HEAP_SEGMENT_CAPACITY)
     {
-        if (memforge_init(NULL) != 0)
+        // Auto-initialize allocator on first use, then route the request properly
+        if (mmap_threshold == 0)
         {
-            errno = ENOMEM;
-            return NULL;
+            if (memforge_init(NULL) != 0)
+            {
+                errno = ENOMEM;
+                return NULL;
+            }
+            return memforge_malloc(size);
+        }
+
+        // Large request: bypass the arenas entirely
+        bool zeroed;
+        block_header_t *block = mapped_alloc(size, &zeroed);
+        if (block != NULL)
+        {
+            ptr = BLOCK_TO_PTR(block);
+            usable = BLOCK_SIZE(block);
         }
     }
+    else
+    {
+        // Round up to the size class so freed blocks can be reused by any request of the class
+        size_t size_class;
+        size_t aligned = size_class_round(size, &size_class);
 
-    // glibc behaviour: malloc(0) returns a unique pointer (not NULL)
-    if (size == 0)
+        if (THREAD_CACHE_ACTIVE() && aligned <= MEMFORGE_THREAD_CACHE_MAX_SIZE)
+        {
+            ptr = thread_cache_alloc(size_class);
+            if (ptr != NULL)
+            {
+                STATS_ADD(thread_cache_hits, 1);
+                if (aligned > MEMFORGE_SLAB_MAX_SIZE)
+                {
+                    BLOCK_SET_MAGIC(PTR_TO_BLOCK(ptr), MEMFORGE_MAGIC_NUMBER); // Leaving the cache
+                }
+            }
+            else
+            {
+                STATS_ADD(thread_cache_misses, 1);
+            }
+        }
+
+        if (ptr == NULL)
+        {
+            ptr = arena_alloc_rounded(get_current_arena(), aligned, size_class);
+        }
+
+        if (ptr != NULL)
+        {
+            usable = aligned <= MEMFORGE_SLAB_MAX_SIZE ? aligned : BLOCK_SIZE(PTR_TO_BLOCK(ptr));
+            stats_record_class(size_class, size, usable);
+        }
+    }
+
+    if (ptr == NULL)
     {
-        size = 1; // Allocate minimum amount
+        errno = ENOMEM;
+        return NULL;
     }
+
+    stats_record_allocation(usable);
+    if (usable >= mmap_threshold)
+    {
+        stats_observe_peak(); // Mapped blocks move usage in large steps
+    }
+    return ptr;
 }
 
 /**
@@ -52,17 +373,610 @@ void memforge_free(void *ptr)
     {
         return;
     }
+
+    // Slab objects have no header: classify the pointer by its segment first
+    heap_segment_t *segment = segment_map_lookup(ptr);
+    if (segment != NULL && segment->arena->user_owned)
+    {
+        memforge_arena_free(segment->arena, ptr); // Never cached
+        return;
+    }
+
+    if (segment != NULL && segment->kind == HEAP_SEGMENT_SLAB)
+    {
+        size_t size_class = slab_run_of(ptr)->size_class;
+        stats_record_free(memforge_size_classes[size_class]);
+
+        if (!thread_cache_free(ptr, size_class))
+        {
+            arena_slab_free(ptr);
+        }
+        return;
+    }
+
+    block_header_t *block = PTR_TO_BLOCK(ptr);
+
+#if MEMFORGE_SAFETY_CHECKS
+    if (block->magic == MEMFORGE_CACHED_MAGIC || (block->magic == MEMFORGE_MAGIC_NUMBER && BLOCK_IS_FREE(block)))
+    {
+        debug_log("Double free detected at %p", ptr);
+        return;
+    }
+    if (!block_validate(block) || BLOCK_IS_MAPPED(block) != (segment == NULL))
+    {
+        debug_log("Invalid pointer passed to memforge_free: %p", ptr);
+        return;
+    }
+#endif
+
+    stats_record_free(BLOCK_SIZE(block));
+
+    if (BLOCK_IS_MAPPED(block))
+    {
+        mapped_free(block);
+        return;
+    }
+
+    size_t size_class = cached_size_class(block);
+    if (size_class < MEMFORGE_SIZE_CLASS_COUNT)
+    {
+        // Marked before the push: a per-CPU cache may hand it out again at once
+        BLOCK_SET_MAGIC(block, MEMFORGE_CACHED_MAGIC);
+        if (thread_cache_free(ptr, size_class))
+        {
+            return;
+        }
+        BLOCK_SET_MAGIC(block, MEMFORGE_MAGIC_NUMBER);
+    }
+
+    arena_free(block);
+}
+
+/**
+ * memforge_free_sized - Releases a block of a size known to the caller
+ * A size in a slab class identifies a slab object's class outright, so the
+ * run descriptor is not read; the segment map is still checked so a heap
+ * block freed with a small size cannot end up in a slab bin. Other blocks
+ * carry their size in their header anyway and take the regular path
+ */
+void memforge_free_sized(void *ptr, size_t size)
+{
+    if (ptr == NULL)
+    {
+        return;
+    }
+
+#if MEMFORGE_SAFETY_CHECKS
+    if (!free_size_matches(ptr, size))
+    {
+        debug_log("Size %zu passed to memforge_free_sized does not match %p", size, ptr);
+        memforge_free(ptr);
+        return;
+    }
+#endif
+
+    size_t size_class;
+    size_t aligned = size_class_round(size == 0 ? 1 : size, &size_class);
+    if (aligned > MEMFORGE_SLAB_MAX_SIZE || size >= memforge_config.mmap_threshold)
+    {
+        memforge_free(ptr);
+        return;
+    }
+
+    heap_segment_t *segment = segment_map_lookup(ptr);
+    if (segment == NULL || segment->kind != HEAP_SEGMENT_SLAB)
+    {
+        memforge_free(ptr);
+        return;
+    }
+
+    memforge_arena_t *arena = segment->arena;
+    if (arena->user_owned)
+    {
+        memforge_arena_free(arena, ptr);
+        return;
+    }
+
+    stats_record_free(aligned);
+    if (!thread_cache_free(ptr, size_class))
+    {
+        arena_slab_free(ptr);
+    }
+}
+
+/**
+ * memforge_malloc_batch - Allocates count blocks of size bytes
+ * Cache hits are taken first; the misses are served by one arena call
+ */
+size_t memforge_malloc_batch(size_t size, size_t count, void **out)
+{
+    if (out == NULL)
+    {
+        errno = EINVAL;
+        return 0;
+    }
+
+    if (size == 0)
+    {
+        size = 1;
+    }
+
+    size_t allocated = 0;
+    size_t mmap_threshold = __atomic_load_n(&memforge_config.mmap_threshold, __ATOMIC_ACQUIRE);
+
+    if (size >= mmap_threshold || size > HEAP_SEGMENT_CAPACITY)
+    {
+        if (mmap_threshold == 0)
+        {
+            if (memforge_init(NULL) != 0)
+            {
+                errno = ENOMEM;
+                return 0;
+            }
+            return memforge_malloc_batch(size, count, out);
+        }
+
+        // Every mapped block is its own mapping: nothing to share
+        while (allocated < count && (out[allocated] = memforge_malloc(size)) != NULL)
+        {
+            allocated++;
+        }
+        return allocated;
+    }
+
+    size_t size_class;
+    size_t aligned = size_class_round(size, &size_class);
+
+    if (THREAD_CACHE_ACTIVE() && aligned <= MEMFORGE_THREAD_CACHE_MAX_SIZE)
+    {
+        while (allocated < count && (out[allocated] = thread_cache_alloc(size_class)) != NULL)
+        {
+            if (aligned > MEMFORGE_SLAB_MAX_SIZE)
+            {
+                BLOCK_SET_MAGIC(PTR_TO_BLOCK(out[allocated]), MEMFORGE_MAGIC_NUMBER); // Leaving the cache
+            }
+            allocated++;
+        }
+
+        STATS_ADD(thread_cache_hits, allocated);
+        STATS_ADD(thread_cache_misses, count - allocated);
+    }
+
+    if (allocated < count)
+    {
+        allocated += arena_malloc_batch(get_current_arena(), aligned, size_class, out + allocated, count - allocated);
+    }
+
+    for (size_t i = 0; i < allocated; i++)
+    {
+        size_t usable = aligned <= MEMFORGE_SLAB_MAX_SIZE ? aligned : BLOCK_SIZE(PTR_TO_BLOCK(out[i]));
+        stats_record_class(size_class, size, usable);
+        stats_record_allocation(usable);
+    }
+
+    if (allocated < count)
+    {
+        errno = ENOMEM;
+    }
+    return allocated;
+}
+
+/**
+ * memforge_free_batch - Frees count blocks
+ * Blocks the thread cache does not take are chained and handed to
+ * arena_release_chain(), which locks each arena once per run of its blocks
+ */
+void memforge_free_batch(void **ptrs, size_t count)
+{
+    if (ptrs == NULL)
+    {
+        return;
+    }
+
+    thread_cache_entry_t *chain = NULL;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        void *ptr = ptrs[i];
+        if (ptr == NULL)
+        {
+            continue;
+        }
+
+        heap_segment_t *segment = segment_map_lookup(ptr);
+        if (segment == NULL || segment->arena->user_owned)
+        {
+            memforge_free(ptr); // Mapped or caller-managed: nothing to batch
+            continue;
+        }
+
+        size_t size_class;
+        if (segment->kind == HEAP_SEGMENT_SLAB)
+        {
+            size_class = slab_run_of(ptr)->size_class;
+            stats_record_free(memforge_size_classes[size_class]);
+        }
+        else
+        {
+            block_header_t *block = PTR_TO_BLOCK(ptr);
+
+#if MEMFORGE_SAFETY_CHECKS
+            if (block->magic == MEMFORGE_CACHED_MAGIC || (block->magic == MEMFORGE_MAGIC_NUMBER && BLOCK_IS_FREE(block)))
+            {
+                debug_log("Double free detected at %p", ptr);
+                continue;
+            }
+            if (!block_validate(block) || BLOCK_IS_MAPPED(block))
+            {
+                debug_log("Invalid pointer passed to memforge_free_batch: %p", ptr);
+                continue;
+            }
+#endif
+
+            stats_record_free(BLOCK_SIZE(block));
+            size_class = cached_size_class(block);
+            BLOCK_SET_MAGIC(block, MEMFORGE_CACHED_MAGIC); // Parked in the cache or the chain
+        }
+
+        if (size_class < MEMFORGE_SIZE_CLASS_COUNT && thread_cache_free(ptr, size_class))
+        {
+            continue;
+        }
+
+        thread_cache_entry_t *entry = ptr;
+        entry->next = chain;
+        chain = entry;
+    }
+
+    arena_release_chain(chain);
+}
+
+/**
+ * memforge_arena_malloc - Allocates size bytes from a caller-managed arena
+ * Caches are bypassed in both directions: blocks come straight from the
+ * arena and go straight back to it
+ */
+void *memforge_arena_malloc(memforge_arena_t *arena, size_t size)
+{
+    if (arena == NULL)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    if (size == 0)
+    {
+        size = 1;
+    }
+
+    if (size > HEAP_SEGMENT_CAPACITY)
+    {
+        errno = ENOMEM; // Would need a private mapping the arena cannot track
+        return NULL;
+    }
+
+    size_t size_class;
+    size_t aligned = size_class_round(size, &size_class);
+    void *ptr = arena_alloc_rounded(arena, aligned, size_class);
+    if (ptr == NULL)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    size_t usable = aligned <= MEMFORGE_SLAB_MAX_SIZE ? aligned : BLOCK_SIZE(PTR_TO_BLOCK(ptr));
+    stats_record_class(size_class, size, usable);
+    stats_record_allocation(usable);
+    return ptr;
+}
+
+/**
+ * memforge_arena_free - Returns a block to its caller-managed arena
+ */
+void memforge_arena_free(memforge_arena_t *arena, void *ptr)
+{
+    if (ptr == NULL)
+    {
+        return;
+    }
+
+    heap_segment_t *segment = segment_map_lookup(ptr);
+    if (arena == NULL || segment == NULL || segment->arena != arena)
+    {
+        debug_log("Pointer %p does not belong to arena %p", ptr, (void *)arena);
+        return;
+    }
+
+    if (segment->kind == HEAP_SEGMENT_SLAB)
+    {
+        stats_record_free(slab_run_of(ptr)->object_size);
+        arena_slab_free(ptr);
+        return;
+    }
+
+    block_header_t *block = PTR_TO_BLOCK(ptr);
+
+#if MEMFORGE_SAFETY_CHECKS
+    if (block->magic == MEMFORGE_CACHED_MAGIC || (block->magic == MEMFORGE_MAGIC_NUMBER && BLOCK_IS_FREE(block)))
+    {
+        debug_log("Double free detected at %p", ptr);
+        return;
+    }
+    if (!block_validate(block))
+    {
+        debug_log("Invalid pointer passed to memforge_arena_free: %p", ptr);
+        return;
+    }
+#endif
+
+    stats_record_free(BLOCK_SIZE(block));
+    arena_free(block);
+}
+
+/**
+ * memforge_usable_size - Returns the number of bytes usable at ptr
+ * Slab objects report their class size, header blocks their block size
+ */
+size_t memforge_usable_size(void *ptr)
+{
+    if (ptr == NULL)
+    {
+        return 0;
+    }
+
+    heap_segment_t *segment = segment_map_lookup(ptr);
+    if (segment != NULL && segment->kind == HEAP_SEGMENT_SLAB)
+    {
+        return slab_run_of(ptr)->object_size;
+    }
+
+    block_header_t *block = PTR_TO_BLOCK(ptr);
+    if (!block_validate(block))
+    {
+        return 0;
+    }
+
+    return BLOCK_SIZE(block);
+}
+
+/**
+ * memforge_malloc_usable_size - malloc_usable_size() compatible alias
+ */
+size_t memforge_malloc_usable_size(void *ptr)
+{
+    return memforge_usable_size(ptr);
+}
+
+/**
+ * memforge_malloc_trim - Returns free heap memory and cached mappings to the OS
+ * The calling thread's cache and its CPU's cache are flushed first so their
+ * blocks can merge with their neighbours; every shared and per-thread arena
+ * is then trimmed
+ */
+size_t memforge_malloc_trim(size_t pad)
+{
+    if (!memforge_initialized)
+    {
+        return 0;
+    }
+
+    thread_cache_flush();
+    if (memforge_config.cpu_cache_enabled)
+    {
+        cpu_cache_drain();
+    }
+
+    size_t released = 0;
+    for (size_t i = 0; i < memforge_config.arena_count; i++)
+    {
+        if (memforge_arenas[i] != NULL)
+        {
+            released += arena_trim(memforge_arenas[i], pad);
+        }
+    }
+
+    size_t count = arena_thread_count();
+    for (size_t i = 0; i < count; i++)
+    {
+        memforge_arena_t *arena = arena_thread_at(i);
+        if (arena != NULL)
+        {
+            released += arena_trim(arena, pad);
+        }
+    }
+
+    released += extent_cache_flush();
+    debug_log("malloc_trim released %zu bytes", released);
+    return released;
 }
 
 /**
  * memforge_calloc - Allocates memory for an array of n elements of size bytes each
- * The memory is set to zero before returning
+ * The memory is set to zero before returning. Large blocks carved from
+ * memory never handed out before (fresh mappings, the untouched part of a
+ * heap segment) are still zero from the kernel past their free-list links,
+ * so only those bytes are cleared and the rest of the pages stay unfaulted
  */
-void *memforge_calloc(size_t n, size_t size) {}
+void *memforge_calloc(size_t n, size_t size)
+{
+    if (size != 0 && n > SIZE_MAX / size)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    size_t total = n * size;
+    if (total <= MEMFORGE_THREAD_CACHE_MAX_SIZE)
+    {
+        // Likely a cache-hot recycled block: clearing it is cheaper than tracking
+        void *ptr = memforge_malloc(total);
+        if (ptr != NULL)
+        {
+            memset(ptr, 0, total);
+        }
+        return ptr;
+    }
+
+    if (!memforge_initialized && memforge_init(NULL) != 0)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    size_t mmap_threshold = __atomic_load_n(&memforge_config.mmap_threshold, __ATOMIC_ACQUIRE);
+    bool zeroed = false;
+    block_header_t *block;
+
+    if (total >= mmap_threshold || total > HEAP_SEGMENT_CAPACITY)
+    {
+        block = mapped_alloc(total, &zeroed);
+    }
+    else
+    {
+        // Above the thread cache limit: straight from the arena, like memforge_malloc()
+        size_t size_class;
+        size_t aligned = size_class_round(total, &size_class);
+        block = arena_malloc(get_current_arena(), aligned, &zeroed);
+        if (block != NULL)
+        {
+            stats_record_class(size_class, total, BLOCK_SIZE(block));
+        }
+    }
+
+    if (block == NULL)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    stats_record_allocation(BLOCK_SIZE(block));
+    if (BLOCK_SIZE(block) >= mmap_threshold)
+    {
+        stats_observe_peak();
+    }
+
+    void *ptr = BLOCK_TO_PTR(block);
+    memset(ptr, 0, zeroed ? FREE_BLOCK_METADATA_SIZE : total);
+    return ptr;
+}
 
 /**
  * memforge_realloc - Changes the size of the memory block pointed to by ptr to size bytes
  * The contents will be unchanged in the range from the start of the region up
- * to the minimum of the old and new sizes.
+ * to the minimum of the old and new sizes. Mapped blocks that stay above the
+ * mmap threshold are resized with mremap. Slab objects stay where they are
+ * while the size class is unchanged, heap blocks while the new size is too
+ * large for a slab class and fills at least half of them, and heap blocks
+ * grow into free space that follows them. Anything else is moved
+ */
+void *memforge_realloc(void *ptr, size_t size)
+{
+    if (ptr == NULL)
+    {
+        return memforge_malloc(size);
+    }
+
+    if (size == 0)
+    {
+        memforge_free(ptr);
+        return NULL;
+    }
+
+    size_t usable = memforge_usable_size(ptr);
+    if (usable == 0)
+    {
+        debug_log("Invalid pointer passed to memforge_realloc: %p", ptr);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    heap_segment_t *segment = segment_map_lookup(ptr);
+    if (segment == NULL)
+    {
+        size_t mmap_threshold = __atomic_load_n(&memforge_config.mmap_threshold, __ATOMIC_ACQUIRE);
+        if (size >= mmap_threshold || size > HEAP_SEGMENT_CAPACITY)
+        {
+            block_header_t *block = mapped_realloc(PTR_TO_BLOCK(ptr), size);
+            if (block != NULL)
+            {
+                if (BLOCK_SIZE(block) != usable)
+                {
+                    stats_record_resize(usable, BLOCK_SIZE(block));
+                    stats_observe_peak();
+                }
+                STATS_ADD(realloc_in_place, 1);
+                return BLOCK_TO_PTR(block);
+            }
+        }
+    }
+    else if (size <= usable)
+    {
+        // Small requests must stay slab objects of their exact class, which
+        // memforge_free_sized() relies on; heap blocks keep up to half slack
+        size_t size_class;
+        bool stays = segment->kind == HEAP_SEGMENT_SLAB ? size_class_round(size, &size_class) == usable
+                                                        : size > MEMFORGE_SLAB_MAX_SIZE && size >= usable / 2;
+        if (stays)
+        {
+            STATS_ADD(realloc_in_place, 1);
+            return ptr;
+        }
+    }
+    else if (segment->kind == HEAP_SEGMENT_BLOCKS && size <= HEAP_SEGMENT_CAPACITY)
+    {
+        // Grown to a class size, the block stays eligible for the caches
+        size_t size_class;
+        block_header_t *block = PTR_TO_BLOCK(ptr);
+        if (arena_grow_block(block, size_class_round(size, &size_class)))
+        {
+            stats_record_resize(usable, BLOCK_SIZE(block));
+            STATS_ADD(realloc_in_place, 1);
+            return ptr;
+        }
+    }
+
+    // Blocks of a caller-managed arena stay in it
+    void *moved = segment != NULL && segment->arena->user_owned ? memforge_arena_malloc(segment->arena, size)
+                                                                : memforge_malloc(size);
+    if (moved == NULL)
+    {
+        return NULL; // errno is set and ptr is still valid
+    }
+
+    memcpy(moved, ptr, size < usable ? size : usable);
+    memforge_free(ptr);
+    STATS_ADD(realloc_moved, 1);
+    return moved;
+}
+
+// ============================================================================
+// MMAP THRESHOLD
+// ============================================================================
+
+/**
+ * memforge_set_mmap_threshold - Fixes the mmap threshold at threshold bytes
+ * Never stores 0, which would route every request back through initialization
  */
-void *memforge_realloc(void *ptr, size_t size) {}
\ No newline at end of file
+void memforge_set_mmap_threshold(size_t threshold)
+{
+    if (!memforge_initialized && memforge_init(NULL) != 0)
+    {
+        return;
+    }
+
+    if (threshold <= MEMFORGE_SLAB_MAX_SIZE)
+    {
+        threshold = MEMFORGE_SLAB_MAX_SIZE + 1; // Slab sizes are never mapped
+    }
+
+    memforge_config.mmap_threshold_fixed = true;
+    __atomic_store_n(&memforge_config.mmap_threshold, threshold, __ATOMIC_RELEASE);
+}
+
+/**
+ * memforge_get_mmap_threshold - Returns the effective mmap threshold
+ */
+size_t memforge_get_mmap_threshold(void)
+{
+    return __atomic_load_n(&memforge_config.mmap_threshold, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,742 @@
+/**
+ * @file arena.c
+ * @brief MemForge arena lifecycle, locking and thread assignment
+ *
+ * Arenas are independent heaps, each guarded by its own mutex. Threads are
+ * spread over the arenas in memforge_arenas so that concurrent allocations
+ * rarely compete for the same lock. Objects freed by a thread that uses a
+ * different arena are pushed onto the owner's lock-free remote-free queue
+ * and handed back in bulk the next time the owner allocates under its lock.
+ *
+ * Under MEMFORGE_ARENA_PER_THREAD every thread gets an arena of its own
+ * instead. When the thread exits its arena, with whatever blocks are still
+ * live in it, goes to a pool and is handed to the next new thread, so
+ * short-lived threads neither leak arenas nor pay for creating one.
+ *
+ * @author KyloReneo
+ * @date 2025
+ * @license GPLv3.0
+ */
+
+#include "../../include/memforge/memforge_internal.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+// ============================================================================
+// THREAD-LOCAL STATE
+// ============================================================================
+
+/**
+ * @var memforge_arena_t* thread_arena
+ * @brief Arena assigned to the calling thread (NULL until first use)
+ */
+static _Thread_local memforge_arena_t *thread_arena = NULL;
+
+/**
+ * @var bool thread_in_mapper
+ * @brief Set while the calling thread runs the user's arena mapper
+ */
+static _Thread_local bool thread_in_mapper = false;
+
+/**
+ * @var atomic_size_t next_arena_index
+ * @brief Round-robin cursor used to hand out arenas to new threads
+ */
+static atomic_size_t next_arena_index = 0;
+
+// ============================================================================
+// PER-THREAD ARENA POOL
+// ============================================================================
+
+/**
+ * @var memforge_arena_t* thread_arenas
+ * @brief Every per-thread arena ever created, linked through all_next
+ */
+static memforge_arena_t *thread_arenas = NULL;
+
+/**
+ * @var memforge_arena_t* arena_pool
+ * @brief Per-thread arenas whose thread exited, linked through pool_next
+ */
+static memforge_arena_t *arena_pool = NULL;
+
+/**
+ * @var size_t thread_arena_count
+ * @brief Number of arenas in thread_arenas
+ */
+static size_t thread_arena_count = 0;
+
+/**
+ * @var pthread_mutex_t arena_pool_lock
+ * @brief Guards thread_arenas, arena_pool and thread_arena_count
+ */
+static pthread_mutex_t arena_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @var pthread_key_t arena_key
+ * @brief Key whose destructor returns a thread's arena to the pool
+ */
+static pthread_key_t arena_key;
+
+/**
+ * @var pthread_once_t arena_key_once
+ * @brief Guards one-time creation of arena_key
+ */
+static pthread_once_t arena_key_once = PTHREAD_ONCE_INIT;
+
+// ============================================================================
+// ARENA LIFECYCLE
+// ============================================================================
+
+/**
+ * arena_create - Maps and initializes an empty arena
+ */
+memforge_arena_t *arena_create(void)
+{
+    memforge_arena_t *arena = system_alloc_mmap(sizeof(memforge_arena_t));
+    if (arena == NULL)
+    {
+        return NULL;
+    }
+
+    // mmap'd memory is zero-filled: free lists, segments and counters start empty
+    if (memforge_config.thread_safe && pthread_mutex_init(&arena->lock, NULL) != 0)
+    {
+        system_free_mmap(arena, sizeof(memforge_arena_t));
+        return NULL;
+    }
+
+    return arena;
+}
+
+/**
+ * arena_destroy - Releases every segment of an arena and the arena itself
+ */
+void arena_destroy(memforge_arena_t *arena)
+{
+    if (arena == NULL)
+    {
+        return;
+    }
+
+    heap_segment_t *segment = arena->heap_segments;
+    while (segment != NULL)
+    {
+        heap_segment_t *next = segment->next;
+        heap_segment_destroy(segment);
+        segment = next;
+    }
+
+    if (memforge_config.thread_safe)
+    {
+        pthread_mutex_destroy(&arena->lock);
+    }
+
+    system_free_mmap(arena, sizeof(memforge_arena_t));
+}
+
+/**
+ * arena_lock - Locks an arena (no-op without thread safety)
+ */
+void arena_lock(memforge_arena_t *arena)
+{
+    if (!memforge_config.thread_safe)
+    {
+        return;
+    }
+
+    if (pthread_mutex_trylock(&arena->lock) != 0)
+    {
+        atomic_fetch_add_explicit(&arena->lock_contentions, 1, memory_order_relaxed);
+        pthread_mutex_lock(&arena->lock);
+    }
+    arena->lock_acquisitions++;
+}
+
+/**
+ * arena_unlock - Unlocks an arena (no-op without thread safety)
+ */
+void arena_unlock(memforge_arena_t *arena)
+{
+    if (memforge_config.thread_safe)
+    {
+        pthread_mutex_unlock(&arena->lock);
+    }
+}
+
+// ============================================================================
+// PER-THREAD ARENAS
+// ============================================================================
+
+/**
+ * arena_thread_exit - Parks an exiting thread's arena in the pool
+ * Blocks still live in it stay where they are; frees from other threads
+ * reach it through its remote-free queue until a new thread adopts it
+ */
+static void arena_thread_exit(void *arg)
+{
+    memforge_arena_t *arena = arg;
+    if (thread_arena == arena)
+    {
+        thread_arena = NULL;
+    }
+
+    pthread_mutex_lock(&arena_pool_lock);
+    arena->pool_next = arena_pool;
+    arena_pool = arena;
+    pthread_mutex_unlock(&arena_pool_lock);
+}
+
+/**
+ * arena_key_create - Creates the thread-exit key (runs once)
+ */
+static void arena_key_create(void)
+{
+    pthread_key_create(&arena_key, arena_thread_exit);
+}
+
+/**
+ * arena_thread_acquire - Gives the calling thread a dedicated arena
+ * Pooled arenas are reused before a new one is created
+ */
+static memforge_arena_t *arena_thread_acquire(void)
+{
+    pthread_once(&arena_key_once, arena_key_create);
+
+    pthread_mutex_lock(&arena_pool_lock);
+    memforge_arena_t *arena = arena_pool;
+    if (arena != NULL)
+    {
+        arena_pool = arena->pool_next;
+        arena->pool_next = NULL;
+    }
+    pthread_mutex_unlock(&arena_pool_lock);
+
+    if (arena == NULL)
+    {
+        arena = arena_create();
+        if (arena == NULL)
+        {
+            return memforge_main_arena; // Out of memory: share the main arena
+        }
+
+        pthread_mutex_lock(&arena_pool_lock);
+        arena->all_next = thread_arenas;
+        thread_arenas = arena;
+        thread_arena_count++;
+        pthread_mutex_unlock(&arena_pool_lock);
+    }
+
+    pthread_setspecific(arena_key, arena);
+    return arena;
+}
+
+/**
+ * arena_thread_count - Returns the number of per-thread arenas created
+ */
+size_t arena_thread_count(void)
+{
+    pthread_mutex_lock(&arena_pool_lock);
+    size_t count = thread_arena_count;
+    pthread_mutex_unlock(&arena_pool_lock);
+    return count;
+}
+
+/**
+ * arena_thread_at - Returns the index-th per-thread arena, or NULL
+ */
+memforge_arena_t *arena_thread_at(size_t index)
+{
+    pthread_mutex_lock(&arena_pool_lock);
+    memforge_arena_t *arena = thread_arenas;
+    while (arena != NULL && index-- > 0)
+    {
+        arena = arena->all_next;
+    }
+    pthread_mutex_unlock(&arena_pool_lock);
+    return arena;
+}
+
+/**
+ * arena_destroy_thread_arenas - Destroys every per-thread arena
+ * Only called from memforge_cleanup(), after other threads have exited
+ */
+void arena_destroy_thread_arenas(void)
+{
+    pthread_mutex_lock(&arena_pool_lock);
+    memforge_arena_t *arena = thread_arenas;
+    thread_arenas = NULL;
+    arena_pool = NULL;
+    thread_arena_count = 0;
+    pthread_mutex_unlock(&arena_pool_lock);
+
+    while (arena != NULL)
+    {
+        memforge_arena_t *next = arena->all_next;
+        arena_destroy(arena);
+        arena = next;
+    }
+}
+
+// ============================================================================
+// THREAD ASSIGNMENT
+// ============================================================================
+
+/**
+ * get_current_arena - Returns the calling thread's arena
+ * Threads are assigned on their first allocation (round-robin unless the
+ * strategy says otherwise) and keep their arena afterwards (unless
+ * contention moves them), so the steady state is a single TLS load
+ */
+memforge_arena_t *get_current_arena(void)
+{
+    if (thread_arena != NULL)
+    {
+        return thread_arena;
+    }
+
+    if (memforge_config.thread_safe && memforge_config.arena_strategy == MEMFORGE_ARENA_PER_THREAD)
+    {
+        thread_arena = arena_thread_acquire();
+        return thread_arena;
+    }
+
+    if (!memforge_config.thread_safe || memforge_config.arena_count <= 1 ||
+        memforge_config.arena_strategy == MEMFORGE_ARENA_SINGLE)
+    {
+        thread_arena = memforge_main_arena;
+        return thread_arena;
+    }
+
+    if (memforge_config.arena_strategy == MEMFORGE_ARENA_CUSTOM && memforge_config.arena_mapper != NULL)
+    {
+        if (thread_in_mapper)
+        {
+            return memforge_main_arena; // The mapper itself allocates: serve it without caching
+        }
+
+        thread_in_mapper = true;
+        size_t index = memforge_config.arena_mapper(memforge_config.arena_mapper_context);
+        thread_in_mapper = false;
+
+        thread_arena = memforge_arenas[index % memforge_config.arena_count];
+        return thread_arena;
+    }
+
+    size_t index = atomic_fetch_add_explicit(&next_arena_index, 1, memory_order_relaxed);
+    thread_arena = memforge_arenas[index % memforge_config.arena_count];
+    return thread_arena;
+}
+
+/**
+ * arena_least_contended - Picks the arena other than busy with the fewest
+ * recorded contention events
+ */
+static memforge_arena_t *arena_least_contended(memforge_arena_t *busy)
+{
+    memforge_arena_t *best = busy;
+    size_t best_contentions = SIZE_MAX;
+
+    for (size_t i = 0; i < memforge_config.arena_count; i++)
+    {
+        memforge_arena_t *arena = memforge_arenas[i];
+        if (arena == busy)
+        {
+            continue;
+        }
+
+        size_t contentions = atomic_load_explicit(&arena->lock_contentions, memory_order_relaxed);
+        if (contentions < best_contentions)
+        {
+            best = arena;
+            best_contentions = contentions;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * arena_lock_for_alloc - Locks the arena an allocation will be served from
+ * Under MEMFORGE_ARENA_CONTENTION_AWARE a thread that finds its arena busy
+ * does not wait for it: the contention is recorded and the thread moves
+ * for good to the least-contended arena. Returns the locked arena
+ */
+static memforge_arena_t *arena_lock_for_alloc(memforge_arena_t *arena)
+{
+    if (!memforge_config.thread_safe || memforge_config.arena_strategy != MEMFORGE_ARENA_CONTENTION_AWARE ||
+        arena != thread_arena)
+    {
+        arena_lock(arena);
+        return arena;
+    }
+
+    if (pthread_mutex_trylock(&arena->lock) != 0)
+    {
+        atomic_fetch_add_explicit(&arena->lock_contentions, 1, memory_order_relaxed);
+
+        memforge_arena_t *target = arena_least_contended(arena);
+        if (target != arena)
+        {
+            thread_arena = target;
+            STATS_ADD(arena_migrations, 1);
+            debug_log("Thread %d moved from arena %p to %p", thread_get_id(), (void *)arena, (void *)target);
+        }
+
+        arena = target;
+        arena_lock(arena);
+        return arena;
+    }
+
+    arena->lock_acquisitions++;
+    return arena;
+}
+
+/**
+ * arena_reset_thread - Forgets the calling thread's arena assignment
+ */
+void arena_reset_thread(void)
+{
+    if (thread_arena != NULL && memforge_config.thread_safe &&
+        memforge_config.arena_strategy == MEMFORGE_ARENA_PER_THREAD)
+    {
+        pthread_setspecific(arena_key, NULL); // The arena is about to be destroyed
+    }
+    thread_arena = NULL;
+}
+
+// ============================================================================
+// REMOTE FREES
+// ============================================================================
+
+/**
+ * arena_is_remote - Tells whether arena is not the calling thread's arena
+ * Caller-managed arenas belong to no thread and are always freed into directly
+ */
+bool arena_is_remote(const memforge_arena_t *arena)
+{
+    return memforge_config.thread_safe && arena != thread_arena && !arena->user_owned;
+}
+
+/**
+ * arena_remote_free - Publishes a chain of freed objects to arena's queue
+ * Multiple producers, single consumer: producers only ever push, and the
+ * lock holder takes the whole queue at once, so the push is ABA-free
+ */
+void arena_remote_free(memforge_arena_t *arena, thread_cache_entry_t *first, thread_cache_entry_t *last, size_t count)
+{
+    thread_cache_entry_t *head = atomic_load_explicit(&arena->remote_frees, memory_order_relaxed);
+    do
+    {
+        last->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&arena->remote_frees, &head, first, memory_order_release,
+                                                    memory_order_relaxed));
+
+    STATS_ADD(remote_frees, count);
+}
+
+/**
+ * arena_drain_remote_frees - Returns every queued remote free to the arena
+ * The caller must hold the arena lock
+ */
+static void arena_drain_remote_frees(memforge_arena_t *arena)
+{
+    if (atomic_load_explicit(&arena->remote_frees, memory_order_relaxed) == NULL)
+    {
+        return;
+    }
+
+    thread_cache_entry_t *entry = atomic_exchange_explicit(&arena->remote_frees, NULL, memory_order_acquire);
+    STATS_ADD(remote_free_drains, 1);
+
+    while (entry != NULL)
+    {
+        thread_cache_entry_t *next = entry->next;
+        arena_release_object(arena, entry);
+        entry = next;
+    }
+}
+
+/**
+ * arena_release_object - Returns a slab object or heap block to arena
+ */
+void arena_release_object(memforge_arena_t *arena, void *ptr)
+{
+    if (HEAP_SEGMENT_OF(ptr)->kind == HEAP_SEGMENT_SLAB)
+    {
+        size_t size = slab_run_of(ptr)->object_size;
+        if (slab_free_object(arena, ptr))
+        {
+            arena->freed += size;
+            arena->live_blocks--;
+        }
+        else
+        {
+            debug_log("Double or invalid free of slab object %p", ptr);
+        }
+        return;
+    }
+
+    block_header_t *block = PTR_TO_BLOCK(ptr);
+    BLOCK_SET_MAGIC(block, MEMFORGE_MAGIC_NUMBER);
+    arena->freed += BLOCK_SIZE(block);
+    arena->live_blocks--;
+    heap_free_block(arena, block);
+}
+
+/**
+ * arena_release_chain - Returns a chain of parked objects to their arenas
+ * Consecutive entries from the same arena are handled together: one lock
+ * acquisition for the thread's own arena, one remote-free push otherwise
+ */
+void arena_release_chain(thread_cache_entry_t *entry)
+{
+    while (entry != NULL)
+    {
+        memforge_arena_t *arena = HEAP_SEGMENT_OF(entry)->arena;
+        thread_cache_entry_t *last = entry;
+        size_t count = 1;
+
+        while (last->next != NULL && HEAP_SEGMENT_OF(last->next)->arena == arena)
+        {
+            last = last->next;
+            count++;
+        }
+
+        thread_cache_entry_t *rest = last->next;
+
+        if (arena_is_remote(arena))
+        {
+            arena_remote_free(arena, entry, last, count);
+        }
+        else
+        {
+            arena_lock(arena);
+            while (entry != rest)
+            {
+                thread_cache_entry_t *next = entry->next;
+                arena_release_object(arena, entry);
+                entry = next;
+            }
+            arena_unlock(arena);
+        }
+
+        entry = rest;
+    }
+}
+
+// ============================================================================
+// ARENA ALLOCATION
+// ============================================================================
+
+/**
+ * arena_malloc - Allocates a heap block under the arena lock
+ * Taking the lock is the slow path, so queued remote frees are drained first
+ */
+block_header_t *arena_malloc(memforge_arena_t *arena, size_t size, bool *zeroed)
+{
+    arena = arena_lock_for_alloc(arena);
+    arena_drain_remote_frees(arena);
+    block_header_t *block = heap_alloc_block(arena, size, zeroed);
+    if (block != NULL)
+    {
+        arena->allocated += BLOCK_SIZE(block);
+        arena->live_blocks++;
+    }
+    arena_unlock(arena);
+
+    return block;
+}
+
+/**
+ * arena_free - Returns a heap block to its owning arena
+ */
+void arena_free(block_header_t *block)
+{
+    memforge_arena_t *arena = HEAP_SEGMENT_OF(block)->arena;
+    thread_cache_entry_t *entry = BLOCK_TO_PTR(block);
+
+    if (arena_is_remote(arena))
+    {
+        BLOCK_SET_MAGIC(block, MEMFORGE_CACHED_MAGIC); // Parked until the owner drains its queue
+        arena_remote_free(arena, entry, entry, 1);
+        return;
+    }
+
+    arena_lock(arena);
+    arena_release_object(arena, entry);
+    arena_unlock(arena);
+}
+
+/**
+ * arena_slab_malloc - Allocates a slab object under the arena lock
+ */
+void *arena_slab_malloc(memforge_arena_t *arena, size_t size_class)
+{
+    arena = arena_lock_for_alloc(arena);
+    arena_drain_remote_frees(arena);
+    void *object = slab_alloc_object(arena, size_class);
+    if (object != NULL)
+    {
+        arena->allocated += memforge_size_classes[size_class];
+        arena->live_blocks++;
+    }
+    arena_unlock(arena);
+
+    return object;
+}
+
+/**
+ * arena_malloc_batch - Serves a whole batch of one class under one lock
+ */
+size_t arena_malloc_batch(memforge_arena_t *arena, size_t size, size_t size_class, void **out, size_t count)
+{
+    size_t allocated = 0;
+
+    arena = arena_lock_for_alloc(arena);
+    arena_drain_remote_frees(arena);
+    if (size <= MEMFORGE_SLAB_MAX_SIZE)
+    {
+        while (allocated < count && (out[allocated] = slab_alloc_object(arena, size_class)) != NULL)
+        {
+            allocated++;
+        }
+        arena->allocated += allocated * size;
+    }
+    else
+    {
+        allocated = heap_alloc_blocks(arena, size, out, count);
+        for (size_t i = 0; i < allocated; i++)
+        {
+            arena->allocated += BLOCK_SIZE(PTR_TO_BLOCK(out[i]));
+        }
+    }
+    arena->live_blocks += allocated;
+    arena_unlock(arena);
+
+    return allocated;
+}
+
+/**
+ * arena_grow_block - Grows a heap block in place under its arena's lock
+ * Taken on the owner's arena even from another thread: the block's
+ * neighbours live in that arena's free lists
+ */
+bool arena_grow_block(block_header_t *block, size_t size)
+{
+    memforge_arena_t *arena = HEAP_SEGMENT_OF(block)->arena;
+    size_t old_size = BLOCK_SIZE(block);
+
+    arena_lock(arena);
+    bool grown = heap_grow_block(arena, block, size);
+    if (grown)
+    {
+        arena->allocated += BLOCK_SIZE(block) - old_size;
+    }
+    arena_unlock(arena);
+
+    return grown;
+}
+
+/**
+ * arena_purge - Purges the decayed free pages of an arena under its lock
+ */
+size_t arena_purge(memforge_arena_t *arena, bool all)
+{
+    arena_lock(arena);
+    size_t purged = heap_purge(arena, system_time_ns(), all);
+    arena_unlock(arena);
+
+    return purged;
+}
+
+/**
+ * arena_trim - Trims an arena's heap blocks and slab runs under its lock
+ * once its remote frees are in
+ */
+size_t arena_trim(memforge_arena_t *arena, size_t pad)
+{
+    arena_lock(arena);
+    arena_drain_remote_frees(arena);
+    size_t released = heap_trim(arena, pad) + slab_trim(arena);
+    arena_unlock(arena);
+
+    return released;
+}
+
+/**
+ * arena_slab_free - Returns a slab object to the arena owning its run
+ */
+void arena_slab_free(void *ptr)
+{
+    memforge_arena_t *arena = HEAP_SEGMENT_OF(ptr)->arena;
+
+    if (arena_is_remote(arena))
+    {
+        thread_cache_entry_t *entry = ptr;
+        arena_remote_free(arena, entry, entry, 1);
+        return;
+    }
+
+    arena_lock(arena);
+    arena_release_object(arena, ptr);
+    arena_unlock(arena);
+}
+
+// ============================================================================
+// PUBLIC ARENA API
+// ============================================================================
+
+/**
+ * memforge_set_arena_mapper - Switches to MEMFORGE_ARENA_CUSTOM with mapper
+ */
+void memforge_set_arena_mapper(memforge_arena_mapper_t mapper, void *context)
+{
+    if (!memforge_initialized && memforge_init(NULL) != 0)
+    {
+        return;
+    }
+
+    memforge_config.arena_mapper_context = context;
+    memforge_config.arena_mapper = mapper;
+    memforge_config.arena_strategy = MEMFORGE_ARENA_CUSTOM;
+}
+
+/**
+ * memforge_arena_new - Creates an empty caller-managed arena
+ */
+memforge_arena_t *memforge_arena_new(void)
+{
+    if (!memforge_initialized && memforge_init(NULL) != 0)
+    {
+        return NULL;
+    }
+
+    memforge_arena_t *arena = arena_create();
+    if (arena != NULL)
+    {
+        arena->user_owned = true;
+    }
+
+    return arena;
+}
+
+/**
+ * memforge_arena_destroy - Unmaps every segment of a caller-managed arena
+ */
+void memforge_arena_destroy(memforge_arena_t *arena)
+{
+    if (arena == NULL || !arena->user_owned)
+    {
+        return;
+    }
+
+    // Blocks still allocated are released along with the segments
+    size_t live = arena->allocated - arena->freed;
+    STATS_ADD(total_freed, live);
+    STATS_SUB(current_usage, live);
+    STATS_ADD(free_count, arena->live_blocks);
+
+    arena_destroy(arena);
+}
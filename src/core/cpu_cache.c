@@ -0,0 +1,287 @@
+/**
+ * @file cpu_cache.c
+ * @brief MemForge per-CPU caches of recently freed blocks
+ *
+ * An alternative to the per-thread caches for programs with many threads:
+ * freed blocks are parked in a bounded stack per logical CPU and size class,
+ * so the memory held by caches scales with the number of cores instead of
+ * the number of threads. The stacks are updated with rseq critical sections
+ * (see rseq_linux.c), which need neither locks nor atomics.
+ *
+ * Enabled with memforge_config_t::cpu_cache_enabled, independently of
+ * memforge_config_t::thread_cache_enabled. When rseq is not available the
+ * option is turned off at initialization in favour of the per-thread
+ * caches; a thread whose own registration fails caches nothing, so the
+ * cached memory never exceeds the per-CPU bound.
+ *
+ * @author KyloReneo
+ * @date 2025
+ * @license GPLv3.0
+ */
+
+#include "../../include/memforge/memforge_internal.h"
+
+#include <unistd.h>
+
+// ============================================================================
+// GLOBAL STATE
+// ============================================================================
+
+/**
+ * @var cpu_cache_t* cpu_caches
+ * @brief One cache per possible CPU, mapped at initialization
+ */
+static cpu_cache_t *cpu_caches = NULL;
+
+/**
+ * @var size_t cpu_cache_count
+ * @brief Number of entries in cpu_caches
+ */
+static size_t cpu_cache_count = 0;
+
+// ============================================================================
+// PRIVATE HELPER FUNCTIONS
+// ============================================================================
+
+/**
+ * cpu_cache_limit - Blocks kept per CPU and size class
+ */
+static size_t cpu_cache_limit(void)
+{
+    size_t limit = memforge_config.thread_cache_size;
+    return limit < MEMFORGE_CPU_CACHE_SIZE ? limit : MEMFORGE_CPU_CACHE_SIZE;
+}
+
+/**
+ * cpu_cache_bin - Returns the calling CPU's bin for a size class
+ * NULL when the CPU id is outside the range sized at initialization
+ */
+static cpu_cache_bin_t *cpu_cache_bin(unsigned int cpu, size_t size_class)
+{
+    if (cpu >= cpu_cache_count)
+    {
+        return NULL;
+    }
+
+    return &cpu_caches[cpu].bins[size_class];
+}
+
+// ============================================================================
+// CPU CACHE API
+// ============================================================================
+
+/**
+ * cpu_cache_init - Maps the per-CPU caches if rseq works on this system
+ */
+int cpu_cache_init(void)
+{
+    if (rseq_thread_area() == NULL)
+    {
+        return -1;
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_CONF);
+    if (cpus <= 0)
+    {
+        return -1;
+    }
+
+    cpu_caches = system_alloc_mmap(sizeof(cpu_cache_t) * (size_t)cpus);
+    if (cpu_caches == NULL)
+    {
+        return -1;
+    }
+
+    cpu_cache_count = (size_t)cpus;
+    return 0;
+}
+
+/**
+ * cpu_cache_alloc - Pops the calling CPU's most recently freed block
+ */
+bool cpu_cache_alloc(size_t size_class, void **ptr)
+{
+    void *area = rseq_thread_area();
+    if (area == NULL)
+    {
+        return false;
+    }
+
+    for (;;)
+    {
+        unsigned int cpu = rseq_current_cpu(area);
+        cpu_cache_bin_t *bin = cpu_cache_bin(cpu, size_class);
+        if (bin == NULL)
+        {
+            return false;
+        }
+
+        int result = rseq_stack_pop(area, cpu, &bin->count, bin->slots, ptr);
+        if (result == 0)
+        {
+            return true;
+        }
+        if (result > 0)
+        {
+            *ptr = NULL; // Empty: the caller allocates from its arena
+            return true;
+        }
+        // Preempted or migrated: retry on the CPU we are on now
+    }
+}
+
+/**
+ * cpu_cache_free - Pushes a freed block onto the calling CPU's cache
+ * A full bin keeps its newest (cache-hot) half and sheds the older half to
+ * the owning arenas. rseq only offers whole pushes and pops, so the bin is
+ * popped empty and the newest half pushed back in order, every step being
+ * a complete rseq operation
+ */
+bool cpu_cache_free(void *ptr, size_t size_class)
+{
+    void *area = rseq_thread_area();
+    size_t limit = cpu_cache_limit();
+    if (area == NULL || limit == 0)
+    {
+        return false;
+    }
+
+    for (;;)
+    {
+        unsigned int cpu = rseq_current_cpu(area);
+        cpu_cache_bin_t *bin = cpu_cache_bin(cpu, size_class);
+        if (bin == NULL)
+        {
+            return false;
+        }
+
+        int result = rseq_stack_push(area, cpu, &bin->count, bin->slots, limit, ptr);
+        if (result == 0)
+        {
+            return true;
+        }
+        if (result < 0)
+        {
+            continue;
+        }
+
+        // Full: take every block, newest first
+        void *popped[MEMFORGE_CPU_CACHE_SIZE];
+        size_t taken = 0;
+        while (taken < limit && rseq_stack_pop(area, cpu, &bin->count, bin->slots, &popped[taken]) == 0)
+        {
+            taken++; // Stops early if migrated or drained by another thread
+        }
+
+        // The older half goes back to the arenas in one batch
+        size_t keep = limit / 2 < taken ? limit / 2 : taken;
+        thread_cache_entry_t *released = NULL;
+        for (size_t i = taken; i > keep; i--)
+        {
+            thread_cache_entry_t *entry = popped[i - 1];
+            entry->next = released;
+            released = entry;
+        }
+
+        // Push the newest half back, the newest block last so it ends on top
+        for (size_t i = keep; i > 0; i--)
+        {
+            if (rseq_stack_push(area, cpu, &bin->count, bin->slots, limit, popped[i - 1]) != 0)
+            {
+                // Migrated or refilled meanwhile: release what is left as well
+                for (; i > 0; i--)
+                {
+                    thread_cache_entry_t *entry = popped[i - 1];
+                    entry->next = released;
+                    released = entry;
+                }
+                break;
+            }
+        }
+
+        arena_release_chain(released);
+    }
+}
+
+/**
+ * cpu_cache_drain - Empties the bins of the CPU the caller runs on
+ * Other CPUs' bins are only safe to pop from their own CPU, so they are
+ * left alone; draining stops if the thread migrates
+ */
+void cpu_cache_drain(void)
+{
+    void *area = rseq_thread_area();
+    if (cpu_caches == NULL || area == NULL)
+    {
+        return;
+    }
+
+    unsigned int cpu = rseq_current_cpu(area);
+    for (size_t i = 0; i < MEMFORGE_SIZE_CLASS_COUNT; i++)
+    {
+        cpu_cache_bin_t *bin = cpu_cache_bin(cpu, i);
+        if (bin == NULL)
+        {
+            return;
+        }
+
+        thread_cache_entry_t *released = NULL;
+        int result;
+        void *object;
+        while ((result = rseq_stack_pop(area, cpu, &bin->count, bin->slots, &object)) <= 0)
+        {
+            if (result < 0)
+            {
+                if (rseq_current_cpu(area) != cpu)
+                {
+                    break; // Migrated: the bins left belong to another CPU now
+                }
+                continue; // Preempted: retry
+            }
+
+            thread_cache_entry_t *entry = object;
+            entry->next = released;
+            released = entry;
+        }
+
+        arena_release_chain(released);
+        if (result < 0)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * cpu_cache_destroy - Returns every cached block and unmaps the caches
+ * Only called from memforge_cleanup(), when no other thread allocates
+ */
+void cpu_cache_destroy(void)
+{
+    if (cpu_caches == NULL)
+    {
+        return;
+    }
+
+    for (size_t cpu = 0; cpu < cpu_cache_count; cpu++)
+    {
+        for (size_t i = 0; i < MEMFORGE_SIZE_CLASS_COUNT; i++)
+        {
+            cpu_cache_bin_t *bin = &cpu_caches[cpu].bins[i];
+            thread_cache_entry_t *released = NULL;
+
+            while (bin->count > 0)
+            {
+                thread_cache_entry_t *entry = bin->slots[--bin->count];
+                entry->next = released;
+                released = entry;
+            }
+
+            arena_release_chain(released);
+        }
+    }
+
+    system_free_mmap(cpu_caches, sizeof(cpu_cache_t) * cpu_cache_count);
+    cpu_caches = NULL;
+    cpu_cache_count = 0;
+}
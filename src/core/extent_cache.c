@@ -0,0 +1,289 @@
+/**
+ * @file extent_cache.c
+ * @brief MemForge cache of freed large mappings
+ *
+ * Blocks above the mmap threshold are normally unmapped on free, and the
+ * next large allocation pays for a fresh mmap plus a page fault on every
+ * page it touches. Programs that repeatedly allocate and free buffers of
+ * similar size therefore keep faulting in the same amount of memory.
+ *
+ * Instead, freed mappings are parked here whole, in geometric size buckets
+ * (four per power of two), and handed back to large allocations of a
+ * similar size. The cache is bounded by MEMFORGE_EXTENT_CACHE_MAX_BYTES,
+ * evicting the oldest extent first, and extents unused for
+ * MEMFORGE_EXTENT_CACHE_DECAY_MS are unmapped the next time the cache is
+ * touched, so an idle program does not hold on to the memory.
+ *
+ * @author KyloReneo
+ * @date 2025
+ * @license GPLv3.0
+ */
+
+#include "../../include/memforge/memforge_internal.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+// ============================================================================
+// GLOBAL STATE
+// ============================================================================
+
+/**
+ * @def EXTENT_BUCKETS_PER_DOUBLING
+ * @brief Size buckets per power of two
+ */
+#define EXTENT_BUCKETS_PER_DOUBLING 4
+
+/**
+ * @def EXTENT_BUCKET_COUNT
+ * @brief Buckets covering every size_t value
+ */
+#define EXTENT_BUCKET_COUNT (sizeof(size_t) * 8 * EXTENT_BUCKETS_PER_DOUBLING)
+
+/**
+ * @var extent_node_t* extent_buckets[]
+ * @brief Cached extents by size bucket, most recently parked first
+ */
+static extent_node_t *extent_buckets[EXTENT_BUCKET_COUNT];
+
+/**
+ * @var extent_node_t* extent_oldest
+ * @brief Oldest cached extent, first to decay or be evicted
+ */
+static extent_node_t *extent_oldest = NULL;
+
+/**
+ * @var extent_node_t* extent_newest
+ * @brief Most recently parked extent
+ */
+static extent_node_t *extent_newest = NULL;
+
+/**
+ * @var atomic_size_t extent_cached_bytes
+ * @brief Total size of the cached extents
+ * Only changed under extent_cache_lock; atomic so allocations can skip an
+ * empty cache without locking
+ */
+static atomic_size_t extent_cached_bytes = 0;
+
+/**
+ * @var pthread_mutex_t extent_cache_lock
+ * @brief Guards every structure of the extent cache
+ */
+static pthread_mutex_t extent_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// ============================================================================
+// PRIVATE HELPER FUNCTIONS
+// ============================================================================
+
+/**
+ * extent_bucket - Bucket of a page-multiple size
+ * The two bits below the leading one select one of four buckets per doubling
+ */
+static size_t extent_bucket(size_t size)
+{
+    size_t log = (sizeof(unsigned long long) * 8 - 1) - (size_t)__builtin_clzll((unsigned long long)size);
+    return log * EXTENT_BUCKETS_PER_DOUBLING + ((size >> (log - 2)) & (EXTENT_BUCKETS_PER_DOUBLING - 1));
+}
+
+/**
+ * extent_unlink - Removes an extent from its bucket and the age list
+ * The caller must hold extent_cache_lock
+ */
+static void extent_unlink(extent_node_t *node)
+{
+    if (node->prev != NULL)
+    {
+        node->prev->next = node->next;
+    }
+    else
+    {
+        extent_buckets[extent_bucket(node->size)] = node->next;
+    }
+    if (node->next != NULL)
+    {
+        node->next->prev = node->prev;
+    }
+
+    if (node->older != NULL)
+    {
+        node->older->newer = node->newer;
+    }
+    else
+    {
+        extent_oldest = node->newer;
+    }
+    if (node->newer != NULL)
+    {
+        node->newer->older = node->older;
+    }
+    else
+    {
+        extent_newest = node->older;
+    }
+
+    atomic_fetch_sub_explicit(&extent_cached_bytes, node->size, memory_order_relaxed);
+}
+
+/**
+ * extent_expire - Unlinks the extents that decayed or no longer fit
+ * Extents older than the decay time go first, then the oldest ones until
+ * the cache is at most limit bytes. They are returned chained through
+ * next, to be unmapped by the caller once the lock is dropped
+ */
+static extent_node_t *extent_expire(uint64_t now, size_t limit)
+{
+    uint64_t decay = (uint64_t)MEMFORGE_EXTENT_CACHE_DECAY_MS * 1000000u;
+    extent_node_t *expired = NULL;
+
+    while (extent_oldest != NULL)
+    {
+        extent_node_t *node = extent_oldest;
+        if (atomic_load_explicit(&extent_cached_bytes, memory_order_relaxed) <= limit &&
+            now - node->cached_at < decay)
+        {
+            break;
+        }
+
+        extent_unlink(node);
+        node->next = expired;
+        expired = node;
+    }
+
+    return expired;
+}
+
+/**
+ * extent_release_chain - Unmaps a chain built by extent_expire()
+ */
+static size_t extent_release_chain(extent_node_t *node)
+{
+    size_t released = 0;
+    while (node != NULL)
+    {
+        extent_node_t *next = node->next;
+        released += node->size;
+        extent_release(node, node->size, node->huge);
+        node = next;
+    }
+
+    return released;
+}
+
+// ============================================================================
+// EXTENT CACHE API
+// ============================================================================
+
+/**
+ * extent_cache_get - Takes the most recently parked extent that fits
+ * Buckets are searched from the request's size up to half again as much.
+ * Huge-page extents are kept for huge requests, which take plain extents too
+ */
+void *extent_cache_get(size_t size, bool huge, size_t *extent_size, bool *extent_huge)
+{
+    if (size > MEMFORGE_EXTENT_CACHE_MAX_EXTENT ||
+        atomic_load_explicit(&extent_cached_bytes, memory_order_relaxed) == 0)
+    {
+        return NULL;
+    }
+
+    size_t limit = size + size / 2;
+    extent_node_t *found = NULL;
+
+    pthread_mutex_lock(&extent_cache_lock);
+    extent_node_t *expired = extent_expire(system_time_ns(), MEMFORGE_EXTENT_CACHE_MAX_BYTES);
+
+    for (size_t bucket = extent_bucket(size); found == NULL && bucket <= extent_bucket(limit); bucket++)
+    {
+        for (extent_node_t *node = extent_buckets[bucket]; node != NULL; node = node->next)
+        {
+            if (node->size >= size && node->size <= limit && (huge || !node->huge))
+            {
+                found = node;
+                extent_unlink(found);
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&extent_cache_lock);
+
+    extent_release_chain(expired);
+
+    if (found != NULL)
+    {
+        *extent_size = found->size;
+        *extent_huge = found->huge;
+    }
+    return found;
+}
+
+/**
+ * extent_cache_put - Parks a freed mapping as the newest extent
+ */
+bool extent_cache_put(void *base, size_t size, bool huge)
+{
+    if (size > MEMFORGE_EXTENT_CACHE_MAX_EXTENT || size > MEMFORGE_EXTENT_CACHE_MAX_BYTES)
+    {
+        return false;
+    }
+
+    uint64_t now = system_time_ns();
+    extent_node_t *node = base;
+    node->size = size;
+    node->cached_at = now;
+    node->huge = huge;
+    node->prev = NULL;
+    node->newer = NULL;
+
+    pthread_mutex_lock(&extent_cache_lock);
+    extent_node_t *expired = extent_expire(now, MEMFORGE_EXTENT_CACHE_MAX_BYTES - size);
+
+    size_t bucket = extent_bucket(size);
+    node->next = extent_buckets[bucket];
+    if (node->next != NULL)
+    {
+        node->next->prev = node;
+    }
+    extent_buckets[bucket] = node;
+
+    node->older = extent_newest;
+    if (extent_newest != NULL)
+    {
+        extent_newest->newer = node;
+    }
+    else
+    {
+        extent_oldest = node;
+    }
+    extent_newest = node;
+    atomic_fetch_add_explicit(&extent_cached_bytes, size, memory_order_relaxed);
+    pthread_mutex_unlock(&extent_cache_lock);
+
+    extent_release_chain(expired);
+    return true;
+}
+
+/**
+ * extent_release - Unmaps an extent for good
+ */
+void extent_release(void *base, size_t size, bool huge)
+{
+    if (huge)
+    {
+        STATS_SUB(huge_page_bytes, size & ~(MEMFORGE_HUGE_PAGE_SIZE - 1));
+    }
+
+    system_free_mmap(base, size);
+}
+
+/**
+ * extent_cache_flush - Unmaps every cached extent
+ */
+size_t extent_cache_flush(void)
+{
+    pthread_mutex_lock(&extent_cache_lock);
+    extent_node_t *expired = extent_expire(0, 0);
+    pthread_mutex_unlock(&extent_cache_lock);
+
+    return extent_release_chain(expired);
+}
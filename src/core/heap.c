@@ -0,0 +1,746 @@
+/**
+ * @file heap.c
+ * @brief MemForge heap segments, blocks and segregated free lists
+ *
+ * This module manages the memory an arena carves allocations from:
+ * - Heap segments mapped from the OS and aligned to their own size
+ * - Block splitting and forward coalescing inside a segment
+ * - Segregated free lists indexed by memforge_size_classes
+ * - Block selection according to the configured allocation strategy
+ * - Time-decay purging of the pages inside large free blocks
+ *
+ * Every function that takes an arena expects the caller to hold its lock.
+ *
+ * @author KyloReneo
+ * @date 2025
+ * @license GPLv3.0
+ */
+
+#include "../../include/memforge/memforge_internal.h"
+
+#include <stdint.h>
+#include <string.h>
+
+// ============================================================================
+// PRIVATE HELPER FUNCTIONS
+// ============================================================================
+
+/**
+ * free_list_index - Picks the free list a block of the given size lives in
+ * Lists are floor-indexed: list i holds blocks with sizes in
+ * [memforge_size_classes[i], memforge_size_classes[i + 1]), so every block
+ * in a list above the one for a request is guaranteed to fit it
+ */
+static size_t free_list_index(size_t size)
+{
+    return get_size_class_floor(size);
+}
+
+_Static_assert(MEMFORGE_MIN_ALLOC_SIZE >= sizeof(free_block_links_t), "free blocks must fit their list links");
+
+/**
+ * block_init - Writes a fresh header at the given address
+ */
+static block_header_t *block_init(void *address, size_t size, bool is_free)
+{
+    block_header_t *block = (block_header_t *)address;
+    block->size_flags = size | (is_free ? BLOCK_FLAG_FREE : 0);
+    BLOCK_SET_MAGIC(block, MEMFORGE_MAGIC_NUMBER);
+    return block;
+}
+
+/**
+ * block_hand_out - Records that the user area of block is about to be used
+ * Returns whether block lay wholly in the never-used part of its segment
+ */
+static bool block_hand_out(block_header_t *block)
+{
+    heap_segment_t *segment = HEAP_SEGMENT_OF(block);
+    bool fresh = (char *)block >= segment->zero_start;
+
+    char *end = (char *)BLOCK_NEXT_PHYSICAL(block);
+    if (end > segment->zero_start)
+    {
+        segment->zero_start = end;
+    }
+
+    return fresh;
+}
+
+/**
+ * heap_purge_decay - The configured decay window in nanoseconds
+ */
+static uint64_t heap_purge_decay(void)
+{
+    size_t ms = memforge_config.purge_decay_ms;
+    return ms >= UINT64_MAX / 1000000u ? UINT64_MAX : (uint64_t)ms * 1000000u;
+}
+
+/**
+ * heap_purge_schedule - Moves the arena's purge deadline no later than the
+ * decay of a block stamped at stamp
+ */
+static void heap_purge_schedule(memforge_arena_t *arena, uint64_t stamp)
+{
+    uint64_t decay = heap_purge_decay();
+    uint64_t due = stamp > UINT64_MAX - decay ? UINT64_MAX : stamp + decay;
+    if (arena->purge_due == 0 || due < arena->purge_due)
+    {
+        arena->purge_due = due;
+    }
+}
+
+/**
+ * block_set_stamp - Records when a free block got dirty (0 = clean)
+ */
+static void block_set_stamp(memforge_arena_t *arena, block_header_t *block, uint64_t stamp)
+{
+    if (!BLOCK_TRACKS_PURGE(block))
+    {
+        return;
+    }
+
+    BLOCK_PURGE_STAMP(block) = stamp;
+    if (stamp != 0)
+    {
+        heap_purge_schedule(arena, stamp);
+    }
+}
+
+/**
+ * block_mark_dirty - Stamps a free block that may hold resident pages
+ * Returns the time used, or 0 when the block is too small to be tracked
+ */
+static uint64_t block_mark_dirty(memforge_arena_t *arena, block_header_t *block)
+{
+    if (!BLOCK_TRACKS_PURGE(block))
+    {
+        return 0;
+    }
+
+    uint64_t now = system_time_ns();
+    block_set_stamp(arena, block, now);
+    return now;
+}
+
+/**
+ * block_is_dirty - Whether a free block may hold resident pages
+ * Blocks too small to carry a stamp are assumed dirty
+ */
+static bool block_is_dirty(block_header_t *block)
+{
+    return !BLOCK_TRACKS_PURGE(block) || BLOCK_PURGE_STAMP(block) != 0;
+}
+
+/**
+ * block_purge - Releases the whole pages inside a free block past its
+ * first keep bytes
+ * Purging all of the last block of a segment also returns it to the
+ * segment's never-used part, so calloc can skip clearing it again
+ */
+static size_t block_purge(block_header_t *block, size_t keep)
+{
+    size_t page_size = memforge_config.page_size;
+    char *start = (char *)BLOCK_TO_PTR(block) + FREE_BLOCK_METADATA_SIZE + keep;
+    char *end = (char *)BLOCK_NEXT_PHYSICAL(block);
+    char *first = (char *)(((uintptr_t)start + page_size - 1) & ~(uintptr_t)(page_size - 1));
+    char *last = (char *)((uintptr_t)end & ~(uintptr_t)(page_size - 1));
+
+    if (last <= first || system_purge_pages(first, (size_t)(last - first)) != 0)
+    {
+        return 0;
+    }
+
+    heap_segment_t *segment = HEAP_SEGMENT_OF(block);
+    if (keep == 0 && end == (char *)segment->base + segment->size - BLOCK_HEADER_SIZE &&
+        (char *)block < segment->zero_start)
+    {
+        // The partial pages at both ends are still resident: clear them
+        memset(start, 0, (size_t)(first - start));
+        memset(last, 0, (size_t)(end - last));
+        segment->zero_start = (char *)block;
+    }
+
+    return (size_t)(last - first);
+}
+
+// ============================================================================
+// HEAP SEGMENTS
+// ============================================================================
+
+/**
+ * heap_segment_create - Places a segment tracker at the base of a region
+ */
+heap_segment_t *heap_segment_create(void *base, size_t size)
+{
+    if (base == NULL || size < HEAP_SEGMENT_OVERHEAD)
+    {
+        return NULL;
+    }
+
+    heap_segment_t *segment = (heap_segment_t *)base;
+    segment->base = base;
+    segment->size = size;
+    segment->next = NULL;
+    segment->arena = NULL;
+    segment->kind = HEAP_SEGMENT_BLOCKS;
+    segment->huge_pages = false;
+    segment->zero_start = (char *)base + HEAP_SEGMENT_OVERHEAD;
+    return segment;
+}
+
+/**
+ * heap_segment_destroy - Returns a whole segment (tracker included) to the OS
+ */
+void heap_segment_destroy(heap_segment_t *segment)
+{
+    if (segment == NULL)
+    {
+        return;
+    }
+
+    if (segment->huge_pages)
+    {
+        STATS_SUB(huge_page_bytes, segment->size);
+    }
+
+    segment_map_unregister(segment);
+    system_free_mmap(segment->base, segment->size);
+}
+
+/**
+ * heap_segment_resident - Bytes of a block segment with a single free block
+ * that may be resident
+ * The pages holding the tracker, the block's metadata and the fencepost
+ * always are; the rest only below zero_start, and only while the block is
+ * dirty
+ */
+static size_t heap_segment_resident(heap_segment_t *segment, bool dirty)
+{
+    uintptr_t page_mask = ~(uintptr_t)(memforge_config.page_size - 1);
+    uintptr_t base = (uintptr_t)segment->base;
+    uintptr_t tail = (base + segment->size - BLOCK_HEADER_SIZE) & page_mask;
+    uintptr_t head = (base + HEAP_SEGMENT_OVERHEAD + BLOCK_HEADER_SIZE + FREE_BLOCK_METADATA_SIZE + ~page_mask) & page_mask;
+
+    uintptr_t used = dirty ? ((uintptr_t)segment->zero_start + ~page_mask) & page_mask : head;
+    used = used < head ? head : used > tail ? tail : used;
+    return (size_t)(used - base) + (size_t)(base + segment->size - tail);
+}
+
+/**
+ * heap_segment_map - Maps, registers and links a fresh segment
+ */
+heap_segment_t *heap_segment_map(memforge_arena_t *arena, heap_segment_kind_t kind)
+{
+    bool huge;
+    void *base = system_alloc_mmap_huge(MEMFORGE_HEAP_SEGMENT_SIZE, MEMFORGE_HEAP_SEGMENT_SIZE, &huge);
+    heap_segment_t *segment = heap_segment_create(base, MEMFORGE_HEAP_SEGMENT_SIZE);
+    if (segment == NULL)
+    {
+        return NULL;
+    }
+
+    if (segment_map_register(segment) != 0)
+    {
+        system_free_mmap(base, MEMFORGE_HEAP_SEGMENT_SIZE);
+        return NULL;
+    }
+
+    segment->kind = kind;
+    segment->huge_pages = huge;
+    segment->arena = arena;
+    segment->next = arena->heap_segments;
+    arena->heap_segments = segment;
+
+    if (huge)
+    {
+        STATS_ADD(huge_page_bytes, MEMFORGE_HEAP_SEGMENT_SIZE);
+    }
+    STATS_ADD(heap_expansions, 1);
+    stats_observe_peak();
+    return segment;
+}
+
+/**
+ * heap_extend - Grows an arena by one aligned segment
+ * Layout: [segment tracker][one free block ........][fencepost header]
+ */
+block_header_t *heap_extend(memforge_arena_t *arena)
+{
+    heap_segment_t *segment = heap_segment_map(arena, HEAP_SEGMENT_BLOCKS);
+    if (segment == NULL)
+    {
+        return NULL;
+    }
+
+    void *base = segment->base;
+    char *first = (char *)base + HEAP_SEGMENT_OVERHEAD;
+    char *fence = (char *)base + MEMFORGE_HEAP_SEGMENT_SIZE - BLOCK_HEADER_SIZE;
+
+    // Zero-sized allocated block that stops forward coalescing at the segment end
+    block_init(fence, 0, false);
+
+    block_header_t *block = block_init(first, (size_t)(fence - first) - BLOCK_HEADER_SIZE, true);
+    block_set_stamp(arena, block, 0); // Fresh pages are not resident yet
+    free_list_add(arena, block);
+
+    debug_log("Arena %p grew by segment %p", (void *)arena, base);
+    return block;
+}
+
+// ============================================================================
+// FREE LIST MANAGEMENT
+// ============================================================================
+
+/**
+ * free_list_add - Pushes a free block onto the head of its list
+ */
+void free_list_add(memforge_arena_t *arena, block_header_t *block)
+{
+    size_t index = free_list_index(BLOCK_SIZE(block));
+    free_block_links_t *links = BLOCK_LINKS(block);
+
+    links->prev = NULL;
+    links->next = arena->free_lists[index];
+    if (links->next != NULL)
+    {
+        BLOCK_LINKS(links->next)->prev = block;
+    }
+    arena->free_lists[index] = block;
+}
+
+/**
+ * free_list_remove - Unlinks a free block from its list in O(1)
+ */
+void free_list_remove(memforge_arena_t *arena, block_header_t *block)
+{
+    free_block_links_t *links = BLOCK_LINKS(block);
+
+    if (links->prev != NULL)
+    {
+        BLOCK_LINKS(links->prev)->next = links->next;
+    }
+    else
+    {
+        arena->free_lists[free_list_index(BLOCK_SIZE(block))] = links->next;
+    }
+
+    if (links->next != NULL)
+    {
+        BLOCK_LINKS(links->next)->prev = links->prev;
+    }
+}
+
+/**
+ * free_list_find - Selects a free block for size bytes and unlinks it
+ *
+ * First-fit returns the first block that fits, best-fit the smallest one in
+ * the first list that has any fit, and hybrid behaves like best-fit but
+ * gives up looking for a better block after MEMFORGE_HYBRID_SEARCH_DEPTH
+ * candidates. Blocks that are too small absorb any free blocks that follow
+ * them, which catches neighbours that forward-only coalescing on free left
+ * apart.
+ */
+block_header_t *free_list_find(memforge_arena_t *arena, size_t size)
+{
+    memforge_strategy_t strategy = memforge_config.strategy;
+
+    for (size_t index = free_list_index(size); index < MEMFORGE_SIZE_CLASS_COUNT; index++)
+    {
+        block_header_t *best = NULL;
+        size_t candidates = 0;
+        block_header_t *block = arena->free_lists[index];
+
+        while (block != NULL)
+        {
+            size_t block_size = BLOCK_SIZE(block);
+            if (block_size < size)
+            {
+                if (!BLOCK_IS_FREE(BLOCK_NEXT_PHYSICAL(block)))
+                {
+                    block = BLOCK_LINKS(block)->next;
+                    continue;
+                }
+
+                // Merge with the free blocks that follow and retry this list
+                free_list_remove(arena, block);
+                block_coalesce(arena, block);
+                if (BLOCK_SIZE(block) >= size)
+                {
+                    return block;
+                }
+
+                block_mark_dirty(arena, block);
+                free_list_add(arena, block);
+                block = arena->free_lists[index];
+                continue;
+            }
+
+            if (strategy == MEMFORGE_STRATEGY_FIRST_FIT || block_size == size)
+            {
+                best = block;
+                break;
+            }
+
+            if (best == NULL || block_size < BLOCK_SIZE(best))
+            {
+                best = block;
+            }
+
+            if (strategy == MEMFORGE_STRATEGY_HYBRID && ++candidates >= MEMFORGE_HYBRID_SEARCH_DEPTH)
+            {
+                break;
+            }
+
+            block = BLOCK_LINKS(block)->next;
+        }
+
+        if (best != NULL)
+        {
+            free_list_remove(arena, best);
+            return best;
+        }
+    }
+
+    return NULL;
+}
+
+// ============================================================================
+// BLOCK MANAGEMENT
+// ============================================================================
+
+/**
+ * block_split - Trims block to size bytes and frees the remainder
+ */
+void block_split(memforge_arena_t *arena, block_header_t *block, size_t size)
+{
+    size_t block_size = BLOCK_SIZE(block);
+    if (block_size < size + BLOCK_HEADER_SIZE + MEMFORGE_MIN_ALLOC_SIZE)
+    {
+        return; // Remainder too small to be useful - keep it as slack
+    }
+
+    block_header_t *remainder = block_init((char *)block + BLOCK_HEADER_SIZE + size,
+                                           block_size - size - BLOCK_HEADER_SIZE, true);
+    BLOCK_SET_SIZE(block, size);
+    free_list_add(arena, remainder);
+}
+
+/**
+ * block_coalesce - Absorbs every free block physically following block
+ * The merged block may now be large enough to carry a stamp whose slot
+ * holds stale bytes, so it is stamped dirty if any of its parts was
+ */
+block_header_t *block_coalesce(memforge_arena_t *arena, block_header_t *block)
+{
+    block_header_t *next = BLOCK_NEXT_PHYSICAL(block);
+    if (!BLOCK_IS_FREE(next))
+    {
+        return block;
+    }
+
+    bool dirty = block_is_dirty(block);
+    while (BLOCK_IS_FREE(next))
+    {
+        dirty = dirty || block_is_dirty(next);
+        free_list_remove(arena, next);
+        BLOCK_SET_SIZE(block, BLOCK_SIZE(block) + BLOCK_HEADER_SIZE + BLOCK_SIZE(next));
+        next = BLOCK_NEXT_PHYSICAL(block);
+    }
+
+    block_set_stamp(arena, block, dirty ? system_time_ns() : 0);
+    return block;
+}
+
+/**
+ * heap_alloc_block - Finds or creates a block and trims it to size
+ */
+block_header_t *heap_alloc_block(memforge_arena_t *arena, size_t size, bool *zeroed)
+{
+    block_header_t *block = free_list_find(arena, size);
+    if (block == NULL)
+    {
+        block = heap_extend(arena);
+        if (block == NULL)
+        {
+            return NULL;
+        }
+        free_list_remove(arena, block);
+    }
+
+    // The remainder split off keeps the block's purge state. Only a tracked
+    // block can leave a tracked remainder, and a free block that is not
+    // split must not hand its stamp to the free neighbour that follows it
+    size_t block_size = BLOCK_SIZE(block);
+    uint64_t stamp = BLOCK_TRACKS_PURGE(block) ? BLOCK_PURGE_STAMP(block) : 0;
+    block_split(arena, block, size);
+    BLOCK_SET_USED(block);
+
+    if (BLOCK_SIZE(block) != block_size)
+    {
+        block_set_stamp(arena, BLOCK_NEXT_PHYSICAL(block), stamp);
+    }
+
+    bool fresh = block_hand_out(block);
+    if (zeroed != NULL)
+    {
+        *zeroed = fresh;
+    }
+    return block;
+}
+
+/**
+ * heap_alloc_blocks - Carves a batch of adjacent blocks
+ * Any slack of a span goes to its last block
+ */
+size_t heap_alloc_blocks(memforge_arena_t *arena, size_t size, void **out, size_t count)
+{
+    size_t stride = BLOCK_HEADER_SIZE + size;
+    size_t per_span = (HEAP_SEGMENT_CAPACITY + BLOCK_HEADER_SIZE) / stride;
+    size_t carved = 0;
+
+    while (carved < count)
+    {
+        size_t span = count - carved < per_span ? count - carved : per_span;
+        block_header_t *block = heap_alloc_block(arena, span * stride - BLOCK_HEADER_SIZE, NULL);
+        if (block == NULL)
+        {
+            break;
+        }
+
+        char *end = (char *)BLOCK_NEXT_PHYSICAL(block);
+        BLOCK_SET_SIZE(block, size);
+        for (size_t i = 1; i < span; i++)
+        {
+            out[carved++] = BLOCK_TO_PTR(block);
+            block = block_init((char *)block + stride, size, false);
+        }
+        BLOCK_SET_SIZE(block, (size_t)(end - (char *)block) - BLOCK_HEADER_SIZE);
+        out[carved++] = BLOCK_TO_PTR(block);
+    }
+
+    return carved;
+}
+
+/**
+ * heap_grow_block - Extends block in place to size bytes
+ * Only merges once the following free blocks are known to make enough room
+ */
+bool heap_grow_block(memforge_arena_t *arena, block_header_t *block, size_t size)
+{
+    size_t available = BLOCK_SIZE(block);
+    block_header_t *next = BLOCK_NEXT_PHYSICAL(block);
+    while (available < size && BLOCK_IS_FREE(next))
+    {
+        available += BLOCK_HEADER_SIZE + BLOCK_SIZE(next);
+        next = BLOCK_NEXT_PHYSICAL(next);
+    }
+
+    if (available < size)
+    {
+        return false;
+    }
+
+    while (BLOCK_SIZE(block) < size)
+    {
+        next = BLOCK_NEXT_PHYSICAL(block);
+        free_list_remove(arena, next);
+        BLOCK_SET_SIZE(block, BLOCK_SIZE(block) + BLOCK_HEADER_SIZE + BLOCK_SIZE(next));
+    }
+
+    block_split(arena, block, size);
+    block_hand_out(block);
+
+    next = BLOCK_NEXT_PHYSICAL(block);
+    if (BLOCK_IS_FREE(next))
+    {
+        block_mark_dirty(arena, next);
+    }
+    return true;
+}
+
+/**
+ * heap_free_block - Marks block free, merges forward and files it
+ */
+void heap_free_block(memforge_arena_t *arena, block_header_t *block)
+{
+    BLOCK_SET_FREE(block);
+    block_coalesce(arena, block);
+    free_list_add(arena, block);
+
+    // Opportunistic purge: only frees large enough to read the clock check
+    uint64_t now = block_mark_dirty(arena, block);
+    if (now != 0 && now >= arena->purge_due)
+    {
+        heap_purge(arena, now, false);
+    }
+}
+
+// ============================================================================
+// PURGING
+// ============================================================================
+
+/**
+ * heap_purge - Purges the free blocks whose dirty pages have decayed
+ * Only the lists that can hold a page-sized block are walked, and the
+ * arena's deadline is moved to the oldest block left dirty
+ */
+size_t heap_purge(memforge_arena_t *arena, uint64_t now, bool all)
+{
+    if (arena->purge_due == 0 || (!all && now < arena->purge_due))
+    {
+        return 0;
+    }
+
+    uint64_t decay = heap_purge_decay();
+    uint64_t oldest = 0;
+    size_t purged = 0;
+
+    arena->purge_due = 0;
+    for (size_t index = free_list_index(memforge_config.page_size); index < MEMFORGE_SIZE_CLASS_COUNT; index++)
+    {
+        for (block_header_t *block = arena->free_lists[index]; block != NULL; block = BLOCK_LINKS(block)->next)
+        {
+            uint64_t stamp = BLOCK_TRACKS_PURGE(block) ? BLOCK_PURGE_STAMP(block) : 0;
+            if (stamp == 0)
+            {
+                continue;
+            }
+
+            if (all || now - stamp >= decay)
+            {
+                size_t released = block_purge(block, 0);
+                if (released != 0)
+                {
+                    purged += released;
+                    BLOCK_PURGE_STAMP(block) = 0;
+                    continue;
+                }
+
+                // No whole page inside or madvise failed: the block stays
+                // dirty and is retried a window from now
+                stamp = now;
+            }
+
+            if (oldest == 0 || stamp < oldest)
+            {
+                oldest = stamp;
+            }
+        }
+    }
+
+    if (oldest != 0)
+    {
+        heap_purge_schedule(arena, oldest);
+    }
+
+    STATS_ADD(purged_bytes, purged);
+    return purged;
+}
+
+/**
+ * heap_trim - Returns an arena's unused heap memory to the kernel
+ * Runs of adjacent free blocks are merged first. A segment left with a
+ * single free block is unmapped, the last free block of the other segments
+ * keeps up to pad bytes resident, and every other dirty free block loses
+ * its whole pages. pad is shared by the arena's segments, newest first
+ */
+size_t heap_trim(memforge_arena_t *arena, size_t pad)
+{
+    size_t released = 0;
+    size_t purged = 0;
+    size_t keep = pad;
+    heap_segment_t **link = &arena->heap_segments;
+
+    while (*link != NULL)
+    {
+        heap_segment_t *segment = *link;
+        if (segment->kind != HEAP_SEGMENT_BLOCKS)
+        {
+            link = &segment->next;
+            continue;
+        }
+
+        block_header_t *first = (block_header_t *)((char *)segment->base + HEAP_SEGMENT_OVERHEAD);
+        char *fence = (char *)segment->base + segment->size - BLOCK_HEADER_SIZE;
+        bool empty = false;
+        bool dirty = false;
+
+        for (block_header_t *block = first; (char *)block < fence; block = BLOCK_NEXT_PHYSICAL(block))
+        {
+            if (!BLOCK_IS_FREE(block))
+            {
+                continue;
+            }
+
+            free_list_remove(arena, block);
+            block_coalesce(arena, block);
+            dirty = block_is_dirty(block);
+
+            size_t kept = 0;
+            if ((char *)BLOCK_NEXT_PHYSICAL(block) == fence)
+            {
+                if (block == first && keep == 0)
+                {
+                    empty = true;
+                    break;
+                }
+
+                kept = keep < BLOCK_SIZE(block) ? keep : BLOCK_SIZE(block);
+                keep -= kept;
+            }
+
+            // Pages kept for pad stay dirty, as does a block nothing could be purged from
+            size_t block_released = dirty ? block_purge(block, kept) : 0;
+            if (block_released != 0 && kept == 0)
+            {
+                block_set_stamp(arena, block, 0);
+            }
+            purged += block_released;
+            free_list_add(arena, block);
+        }
+
+        if (empty)
+        {
+            *link = segment->next;
+            released += heap_segment_resident(segment, dirty);
+            debug_log("Arena %p released segment %p", (void *)arena, segment->base);
+            heap_segment_destroy(segment);
+            continue;
+        }
+
+        link = &segment->next;
+    }
+
+    STATS_ADD(purged_bytes, purged);
+    return released + purged;
+}
+
+// ============================================================================
+// VALIDATION
+// ============================================================================
+
+/**
+ * block_validate - Sanity-checks a block header
+ */
+bool block_validate(block_header_t *block)
+{
+    if (block == NULL || !MEMFORGE_IS_ALIGNED(block))
+    {
+        return false;
+    }
+
+#if MEMFORGE_SAFETY_CHECKS
+    if (block->magic != MEMFORGE_MAGIC_NUMBER && block->magic != MEMFORGE_CACHED_MAGIC)
+    {
+        return false;
+    }
+#endif
+
+    if (BLOCK_IS_HUGE(block) && !BLOCK_IS_MAPPED(block))
+    {
+        return false; // Only mapped blocks carry the huge page flag
+    }
+
+    return (block->size_flags & (BLOCK_FLAG_MASK & ~(BLOCK_FLAG_FREE | BLOCK_FLAG_MAPPED | BLOCK_FLAG_HUGE))) == 0; // Unused flag bits stay clear
+}
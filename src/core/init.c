@@ -14,6 +14,9 @@
 #include "../../include/memforge/memforge_internal.h"
 #include "../../include/memforge/memforge.h"
 
+#include <string.h>
+#include <unistd.h>
+
 // ============================================================================
 // GLOBAL STATE DEFINITIONS
 // ============================================================================
@@ -30,17 +33,6 @@
  */
 memforge_config_t memforge_config = {0};
 
-/**
- * @var memforge_stats_t memforge_stats
- * @brief Global allocation statistics tracker
- *
- * Maintains runtime statistics for monitoring allocator performance:
- * - Total bytes allocated/freed
- * - Current and peak memory usage
- * - Allocation/deallocation counts
- */
-memforge_stats_t memforge_stats = {0};
-
 /**
  * @var memforge_arena_t* memforge_main_arena
  * @brief Primary memory arena for single-threaded operations
@@ -60,33 +52,51 @@ memforge_arena_t *memforge_main_arena = NULL;
 memforge_arena_t **memforge_arenas = NULL;
 
 /**
- * @var bool memforge_initialized
+ * @var atomic_bool memforge_initialized
  * @brief Initialization state flag
  *
  * Prevents double-initialization and ensures proper cleanup sequence.
- * Guards against using uninitialized allocator state.
+ * Guards against using uninitialized allocator state. Set with release
+ * semantics once every other piece of global state is in place.
+ */
+atomic_bool memforge_initialized = false;
+
+/**
+ * @var pthread_mutex_t memforge_init_lock
+ * @brief Serializes concurrent first-time initialization
  */
-bool memforge_initialized = false;
+static pthread_mutex_t memforge_init_lock = PTHREAD_MUTEX_INITIALIZER;
 
 /**
  * @var size_t memforge_size_classes[MEMFORGE_SIZE_CLASS_COUNT]
  * @brief Size classes for segregated free lists
  *
- * Implements power-of-two size classes with spacing to optimize allocation speed:
- * - Small  sizes (16-2048 bytes): Fine-grained for common allocations
- * - Medium sizes (4K-64K)       : Balanced for typical objects
- * - Large  sizes (128K-512K)    : Coarse-grained for big allocations
+ * Implements geometric size classes with four classes per doubling:
+ * - Tiny   sizes (16-64 bytes) : Every MEMFORGE_ALIGNMENT step
+ * - Larger sizes (64B-512K)    : Spaced by a quarter of the enclosing power of two
+ *
+ * A request is rounded up to its class, so from 64 bytes on at most ~20% of
+ * a block is internal fragmentation (a 1025-byte request gets 1280 bytes, not
+ * 2048). Below 64 bytes the alignment step dominates the waste.
  *
  * Segregated free lists reduce search time by only scanning appropriate size buckets.
  */
 size_t memforge_size_classes[MEMFORGE_SIZE_CLASS_COUNT] = {
-    16, 32, 64, 128, 256, 512, 1024, 2048,
-    4096, 8192, 16384, 32768, 65536, 131072, 262144, 524288};
+    16, 24, 32, 40, 48, 56, 64, 80,
+    96, 112, 128, 160, 192, 224, 256, 320,
+    384, 448, 512, 640, 768, 896, 1024, 1280,
+    1536, 1792, 2048, 2560, 3072, 3584, 4096, 5120,
+    6144, 7168, 8192, 10240, 12288, 14336, 16384, 20480,
+    24576, 28672, 32768, 40960, 49152, 57344, 65536, 81920,
+    98304, 114688, 131072, 163840, 196608, 229376, 262144, 327680,
+    393216, 458752, 524288};
 
 // ============================================================================
 // INITIALIZATION FUNCTIONS
 // ============================================================================
 
+static int memforge_init_locked(const memforge_config_t *config);
+
 /**
  * @brief Initializes the MemForge allocator with default or provided configuration
  *
@@ -104,6 +114,8 @@ size_t memforge_size_classes[MEMFORGE_SIZE_CLASS_COUNT] = {
  *
  * @note This function is thread-safe and idempotent. Subsequent calls after
  *       successful initialization will return immediately with success.
+ *       Concurrent first calls are serialized; exactly one of them
+ *       initializes.
  *
  * @warning Do not call allocation functions (malloc/free) before successful
  *          initialization. The allocator uses lazy initialization on first
@@ -130,11 +142,38 @@ size_t memforge_size_classes[MEMFORGE_SIZE_CLASS_COUNT] = {
  */
 int memforge_init(const memforge_config_t *config)
 {
-    if (memforge_initialized)
+    if (atomic_load_explicit(&memforge_initialized, memory_order_acquire))
     {
         return 0; // Already initialized
     }
 
+    // Threads racing through their first allocation all end up here: one
+    // initializes, the others wait for it and then see the flag set
+    pthread_mutex_lock(&memforge_init_lock);
+    int result = 0;
+    if (!atomic_load_explicit(&memforge_initialized, memory_order_relaxed))
+    {
+        result = memforge_init_locked(config);
+    }
+    pthread_mutex_unlock(&memforge_init_lock);
+
+    return result;
+}
+
+/**
+ * @brief Performs the initialization guarded by memforge_init()
+ *
+ * The mmap threshold is what lets memforge_malloc() skip any
+ * "initialized?" test: it reads 0 until initialization is complete, which
+ * sends every request to the large-allocation branch, and that branch
+ * initializes the allocator before going on. The real threshold is
+ * therefore published last, with release semantics.
+ *
+ * @param[in] config User-provided configuration, or NULL for defaults
+ * @return int 0 on success, -1 on failure
+ */
+static int memforge_init_locked(const memforge_config_t *config)
+{
     // Initialize default configuration
     if (memforge_init_default_config() != 0)
     {
@@ -144,14 +183,44 @@ int memforge_init(const memforge_config_t *config)
     // Override with user configuration if provided
     if (config != NULL)
     {
+        memforge_config_t defaults = memforge_config;
         memforge_config = *config;
+
+        // Fields left at zero keep their detected/default values
+        if (memforge_config.page_size == 0)
+        {
+            memforge_config.page_size = defaults.page_size;
+        }
+        if (memforge_config.mmap_threshold == 0)
+        {
+            memforge_config.mmap_threshold = defaults.mmap_threshold;
+        }
+        if (memforge_config.mmap_threshold_max == 0)
+        {
+            memforge_config.mmap_threshold_max = defaults.mmap_threshold_max;
+        }
+        if (memforge_config.arena_count == 0)
+        {
+            memforge_config.arena_count = defaults.arena_count;
+        }
+        if (memforge_config.thread_cache_size == 0)
+        {
+            memforge_config.thread_cache_size = defaults.thread_cache_size;
+        }
+        if (memforge_config.purge_decay_ms == 0)
+        {
+            memforge_config.purge_decay_ms = defaults.purge_decay_ms;
+        }
     }
 
-    // Initialize arenas for multi-threaded operation
-    if (memforge_init_arenas() != 0)
+    // Hold the threshold back until the rest of the state is ready. Slab
+    // sizes are never mapped: memforge_free_sized() relies on it
+    size_t mmap_threshold = memforge_config.mmap_threshold;
+    if (mmap_threshold <= MEMFORGE_SLAB_MAX_SIZE)
     {
-        return -1;
+        mmap_threshold = MEMFORGE_SLAB_MAX_SIZE + 1;
     }
+    memforge_config.mmap_threshold = 0;
 
     // Initialize size classes with proper memory alignment
     for (size_t i = 0; i < MEMFORGE_SIZE_CLASS_COUNT; i++)
@@ -159,7 +228,33 @@ int memforge_init(const memforge_config_t *config)
         memforge_size_classes[i] = MEMFORGE_ALIGN(memforge_size_classes[i]);
     }
 
-    memforge_initialized = true;
+    // Build the O(1) size-to-class lookup tables from the aligned classes
+    size_class_init();
+
+    // Initialize arenas for multi-threaded operation
+    if (memforge_init_arenas() != 0)
+    {
+        return -1;
+    }
+
+    // Per-CPU caches need rseq; without it the thread caches take over
+    if (memforge_config.cpu_cache_enabled && cpu_cache_init() != 0)
+    {
+        memforge_config.cpu_cache_enabled = false;
+        memforge_config.thread_cache_enabled = true;
+        debug_log("rseq unavailable, using per-thread caches");
+    }
+
+    // Threads started from here on see complete size classes and arenas.
+    // The purge thread locks arenas, which is only meaningful with thread safety
+    if (memforge_config.purge_thread && (!memforge_config.thread_safe || purge_thread_start() != 0))
+    {
+        memforge_config.purge_thread = false;
+        debug_log("Background purging unavailable, purging on free only");
+    }
+
+    __atomic_store_n(&memforge_config.mmap_threshold, mmap_threshold, __ATOMIC_RELEASE);
+    atomic_store_explicit(&memforge_initialized, true, memory_order_release);
     debug_log("MemForge initialized successfully");
     return 0;
 }
@@ -172,6 +267,8 @@ int memforge_init(const memforge_config_t *config)
  * - Sets allocation strategy to hybrid (balanced performance/fragmentation)
  * - Enables thread safety by default
  * - Configures mmap threshold for large allocations
+ * - Enables per-thread caches with MEMFORGE_THREAD_CACHE_SIZE blocks per class
+ *   (per-CPU caches are opt-in)
  *
  * @return int 0 on success, -1 on failure
  *
@@ -208,10 +305,21 @@ int memforge_init_default_config(void)
     }
 
     memforge_config.mmap_threshold = MEMFORGE_DEFAULT_MMAP_THRESHOLD;
+    memforge_config.mmap_threshold_max = MEMFORGE_MMAP_THRESHOLD_MAX;
+    memforge_config.mmap_threshold_fixed = false;
     memforge_config.strategy = MEMFORGE_STRATEGY_HYBRID;
     memforge_config.thread_safe = MEMFORGE_THREAD_SAFE;
     memforge_config.debug_enabled = DEBUG_LOGGING;
     memforge_config.arena_count = MEMFORGE_DEFAULT_ARENA_COUNT;
+    memforge_config.thread_cache_enabled = true;
+    memforge_config.thread_cache_size = MEMFORGE_THREAD_CACHE_SIZE;
+    memforge_config.cpu_cache_enabled = false;
+    memforge_config.arena_strategy = MEMFORGE_ARENA_DEFAULT;
+    memforge_config.arena_mapper = NULL;
+    memforge_config.arena_mapper_context = NULL;
+    memforge_config.huge_pages = MEMFORGE_HUGE_PAGES_DEFAULT;
+    memforge_config.purge_decay_ms = MEMFORGE_PURGE_DECAY_MS;
+    memforge_config.purge_thread = false;
 
     return 0;
 }
@@ -294,12 +402,17 @@ int memforge_init_arenas(void)
  *
  * @note This function is idempotent - safe to call multiple times
  * @warning After cleanup, any outstanding allocated memory becomes invalid
+ * @warning Only the calling thread's cache is flushed; other threads that
+ *          allocated must have exited before cleanup
  *
  * @par Cleanup Sequence:
- * 1. Destroy all arena objects and their internal structures
- * 2. Free the arena pointer array via system_free_mmap()
- * 3. Reset global pointers to NULL
- * 4. Mark allocator as uninitialized
+ * 1. Flush the calling thread's cache and the per-CPU caches, and forget
+ *    the calling thread's arena assignment
+ * 2. Destroy all arena objects (per-thread arenas included) and their
+ *    internal structures
+ * 3. Free the arena pointer array via system_free_mmap()
+ * 4. Reset global pointers to NULL
+ * 5. Mark allocator as uninitialized
  *
  * @see memforge_init()
  * @see memforge_reset()
@@ -311,6 +424,14 @@ void memforge_cleanup(void)
         return;
     }
 
+    // Nothing may purge arenas while they are torn down
+    purge_thread_stop();
+
+    // Drop the calling thread's cached blocks and arena before their arenas go away
+    thread_cache_flush();
+    cpu_cache_destroy();
+    arena_reset_thread();
+
     // Destroy all arenas
     for (size_t i = 0; i < memforge_config.arena_count; i++)
     {
@@ -320,6 +441,9 @@ void memforge_cleanup(void)
         }
     }
 
+    arena_destroy_thread_arenas();
+    extent_cache_flush();
+
     // Free arena array
     if (memforge_arenas != NULL)
     {
@@ -328,7 +452,8 @@ void memforge_cleanup(void)
     }
 
     memforge_main_arena = NULL;
-    memforge_initialized = false;
+    memforge_config.mmap_threshold = 0; // Routes the next malloc back through memforge_init()
+    atomic_store_explicit(&memforge_initialized, false, memory_order_release);
 
     debug_log("MemForge cleanup completed");
 }
@@ -348,7 +473,7 @@ void memforge_cleanup(void)
  *
  * @par Reset Sequence:
  * 1. memforge_cleanup() - Release all resources
- * 2. memset(&memforge_stats, 0) - Reset statistics
+ * 2. stats_reset() - Reset statistics
  * 3. memforge_init(NULL) - Reinitialize with defaults
  *
  * @see memforge_cleanup()
@@ -359,7 +484,9 @@ void memforge_cleanup(void)
  * void test_allocator() {
  *     memforge_reset(); // Clean state for test
  *     // Run test operations...
- *     assert(memforge_stats.allocation_count == expected);
+ *     memforge_stats_t stats;
+ *     memforge_get_stats(&stats);
+ *     assert(stats.allocation_count == expected);
  *     memforge_reset(); // Cleanup for next test
  * }
  * @endcode
@@ -367,6 +494,19 @@ void memforge_cleanup(void)
 void memforge_reset(void)
 {
     memforge_cleanup();
-    memset(&memforge_stats, 0, sizeof(memforge_stats_t));
+    stats_reset();
     memforge_init(NULL);
-}
\ No newline at end of file
+}
+
+#if MEMFORGE_INIT_CONSTRUCTOR
+/**
+ * @brief Initializes the allocator with defaults when the library is loaded
+ *
+ * Moves the one-time setup out of the first allocation. A later
+ * memforge_init() call with a custom configuration is then a no-op.
+ */
+__attribute__((constructor)) static void memforge_constructor(void)
+{
+    memforge_init(NULL);
+}
+#endif
@@ -0,0 +1,442 @@
+/**
+ * @file object_cache.c
+ * @brief MemForge typed object caches
+ *
+ * Caches in the style of the kernel's kmem_cache: each one serves objects
+ * of a single size and alignment from slabs of its own, and a freed object
+ * keeps its constructed state until it is handed out again. The
+ * constructor therefore runs once per object carved and the destructor
+ * once when the object's slab is released, instead of on every alloc/free
+ * pair.
+ *
+ * Slabs are mapped aligned to their size, so the slab of an object is
+ * found by masking its address. Each cache is protected by its own lock;
+ * constructors and destructors run outside of it.
+ *
+ * @author KyloReneo
+ * @date 2025
+ * @license GPLv3.0
+ */
+
+#include "../../include/memforge/memforge_internal.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+// ============================================================================
+// GLOBAL STATE
+// ============================================================================
+
+/**
+ * @var memforge_cache_t* cache_list
+ * @brief Every live cache, most recently created first
+ */
+static memforge_cache_t *cache_list = NULL;
+
+/**
+ * @var size_t cache_count
+ * @brief Number of entries in cache_list
+ */
+static size_t cache_count = 0;
+
+/**
+ * @var pthread_mutex_t cache_list_lock
+ * @brief Protects cache_list and cache_count
+ */
+static pthread_mutex_t cache_list_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// ============================================================================
+// PRIVATE HELPER FUNCTIONS
+// ============================================================================
+
+/**
+ * cache_layout - Sizes the slabs of a cache
+ * Starts at MEMFORGE_CACHE_SLAB_SIZE and doubles until a slab holds
+ * MEMFORGE_CACHE_SLAB_MIN_OBJECTS objects behind its header and index stack
+ */
+static bool cache_layout(memforge_cache_t *cache, size_t align)
+{
+    if (cache->stride > SIZE_MAX / (4 * MEMFORGE_CACHE_SLAB_MIN_OBJECTS))
+    {
+        return false;
+    }
+
+    for (size_t slab_size = MEMFORGE_CACHE_SLAB_SIZE;; slab_size *= 2)
+    {
+        size_t capacity = (slab_size - sizeof(cache_slab_t)) / (cache->stride + sizeof(unsigned int));
+        while (capacity >= MEMFORGE_CACHE_SLAB_MIN_OBJECTS)
+        {
+            size_t offset = sizeof(cache_slab_t) + capacity * sizeof(unsigned int);
+            offset = (offset + align - 1) & ~(align - 1);
+            if (offset + capacity * cache->stride <= slab_size)
+            {
+                cache->slab_size = slab_size;
+                cache->objects_offset = offset;
+                cache->capacity = capacity > UINT32_MAX ? UINT32_MAX : (unsigned int)capacity;
+                return true;
+            }
+            capacity--; // Alignment padding pushed the last object out
+        }
+    }
+}
+
+/**
+ * cache_object - Address of object index of a slab
+ */
+static void *cache_object(const memforge_cache_t *cache, cache_slab_t *slab, unsigned int index)
+{
+    return (char *)slab + cache->objects_offset + (size_t)index * cache->stride;
+}
+
+/**
+ * cache_list_push - Links a slab at the head of one of the cache's lists
+ */
+static void cache_list_push(cache_slab_t **list, cache_slab_t *slab)
+{
+    slab->prev = NULL;
+    slab->next = *list;
+    if (*list != NULL)
+    {
+        (*list)->prev = slab;
+    }
+    *list = slab;
+}
+
+/**
+ * cache_list_remove - Unlinks a slab from one of the cache's lists
+ */
+static void cache_list_remove(cache_slab_t **list, cache_slab_t *slab)
+{
+    if (slab->prev != NULL)
+    {
+        slab->prev->next = slab->next;
+    }
+    else
+    {
+        *list = slab->next;
+    }
+
+    if (slab->next != NULL)
+    {
+        slab->next->prev = slab->prev;
+    }
+}
+
+/**
+ * cache_slab_create - Maps an empty slab (caller holds the cache lock)
+ */
+static cache_slab_t *cache_slab_create(memforge_cache_t *cache)
+{
+    cache_slab_t *slab = system_alloc_mmap_aligned(cache->slab_size, cache->slab_size);
+    if (slab == NULL)
+    {
+        return NULL;
+    }
+
+    // mmap'd memory is zero-filled: nothing carved, nothing free
+    slab->cache = cache;
+    cache->slab_count++;
+    return slab;
+}
+
+/**
+ * cache_slab_release - Destroys the free objects of a slab and unmaps it
+ * Called without the cache lock; the slab is already unlinked and counted out
+ */
+static void cache_slab_release(memforge_cache_t *cache, cache_slab_t *slab)
+{
+    if (cache->dtor != NULL)
+    {
+        for (unsigned int i = 0; i < slab->free_count; i++)
+        {
+            cache->dtor(cache_object(cache, slab, slab->free_objects[i]));
+        }
+    }
+
+    system_free_mmap(slab, cache->slab_size);
+}
+
+/**
+ * cache_release_list - Releases every slab of a list (cache being destroyed)
+ */
+static void cache_release_list(memforge_cache_t *cache, cache_slab_t *slab)
+{
+    while (slab != NULL)
+    {
+        cache_slab_t *next = slab->next;
+        cache_slab_release(cache, slab);
+        slab = next;
+    }
+}
+
+// ============================================================================
+// PUBLIC CACHE API
+// ============================================================================
+
+/**
+ * memforge_cache_create - Sets up an empty cache and registers it
+ */
+memforge_cache_t *memforge_cache_create(const char *name, size_t size, size_t align,
+                                        memforge_cache_fn_t ctor, memforge_cache_fn_t dtor)
+{
+    if (align == 0)
+    {
+        align = MEMFORGE_ALIGNMENT;
+    }
+
+    if (!is_power_of_two(align) || align > MEMFORGE_CACHE_SLAB_SIZE || size > SIZE_MAX - align)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    memforge_cache_t *cache = system_alloc_mmap(sizeof(memforge_cache_t));
+    if (cache == NULL)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    cache->stride = ((size == 0 ? 1 : size) + align - 1) & ~(align - 1);
+    if (!cache_layout(cache, align) || pthread_mutex_init(&cache->lock, NULL) != 0)
+    {
+        system_free_mmap(cache, sizeof(memforge_cache_t));
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    if (name != NULL)
+    {
+        strncpy(cache->name, name, MEMFORGE_CACHE_NAME_MAX - 1);
+    }
+    cache->ctor = ctor;
+    cache->dtor = dtor;
+
+    pthread_mutex_lock(&cache_list_lock);
+    cache->next = cache_list;
+    cache_list = cache;
+    cache_count++;
+    pthread_mutex_unlock(&cache_list_lock);
+
+    debug_log("Cache '%s' created: %zu-byte objects, %u per %zu-byte slab", cache->name, cache->stride,
+              cache->capacity, cache->slab_size);
+    return cache;
+}
+
+/**
+ * memforge_cache_alloc - Hands out a free object, constructing it if new
+ * Previously freed objects are preferred; they are already constructed
+ */
+void *memforge_cache_alloc(memforge_cache_t *cache)
+{
+    if (cache == NULL)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+
+    cache_slab_t *slab = cache->partial;
+    if (slab == NULL)
+    {
+        slab = cache->empty;
+        cache->empty = NULL;
+        if (slab == NULL && (slab = cache_slab_create(cache)) == NULL)
+        {
+            pthread_mutex_unlock(&cache->lock);
+            errno = ENOMEM;
+            return NULL;
+        }
+        cache_list_push(&cache->partial, slab);
+    }
+
+    bool construct = slab->free_count == 0;
+    unsigned int index;
+    if (construct)
+    {
+        index = slab->carved++;
+    }
+    else
+    {
+        index = slab->free_objects[--slab->free_count];
+        cache->objects_cached--;
+    }
+
+    if (slab->free_count == 0 && slab->carved == cache->capacity)
+    {
+        cache_list_remove(&cache->partial, slab);
+        cache_list_push(&cache->full, slab);
+    }
+    cache->objects_in_use++;
+
+    pthread_mutex_unlock(&cache->lock);
+
+    void *object = cache_object(cache, slab, index);
+    if (construct && cache->ctor != NULL)
+    {
+        cache->ctor(object);
+    }
+    return object;
+}
+
+/**
+ * memforge_cache_free - Puts an object back on its slab's free stack
+ * A slab left without allocated objects becomes the cache's spare, or is
+ * released if there already is one
+ */
+void memforge_cache_free(memforge_cache_t *cache, void *object)
+{
+    if (cache == NULL || object == NULL)
+    {
+        return;
+    }
+
+    cache_slab_t *slab = (cache_slab_t *)((uintptr_t)object & ~(uintptr_t)(cache->slab_size - 1));
+    size_t offset = (size_t)((char *)object - (char *)slab);
+
+#if MEMFORGE_SAFETY_CHECKS
+    if (slab->cache != cache || offset < cache->objects_offset ||
+        (offset - cache->objects_offset) % cache->stride != 0 ||
+        (offset - cache->objects_offset) / cache->stride >= slab->carved)
+    {
+        debug_log("Invalid pointer passed to memforge_cache_free: %p (cache '%s')", object, cache->name);
+        return;
+    }
+#endif
+
+    unsigned int index = (unsigned int)((offset - cache->objects_offset) / cache->stride);
+    cache_slab_t *release = NULL;
+
+    pthread_mutex_lock(&cache->lock);
+
+#if MEMFORGE_SAFETY_CHECKS
+    for (unsigned int i = 0; i < slab->free_count; i++)
+    {
+        if (slab->free_objects[i] == index)
+        {
+            pthread_mutex_unlock(&cache->lock);
+            debug_log("Double free detected at %p (cache '%s')", object, cache->name);
+            return;
+        }
+    }
+#endif
+
+    if (slab->free_count == 0 && slab->carved == cache->capacity)
+    {
+        cache_list_remove(&cache->full, slab);
+        cache_list_push(&cache->partial, slab);
+    }
+
+    slab->free_objects[slab->free_count++] = index;
+    cache->objects_in_use--;
+    cache->objects_cached++;
+
+    if (slab->free_count == slab->carved)
+    {
+        cache_list_remove(&cache->partial, slab);
+        if (cache->empty == NULL)
+        {
+            cache->empty = slab;
+        }
+        else
+        {
+            release = slab;
+            cache->slab_count--;
+            cache->objects_cached -= slab->free_count;
+        }
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+
+    if (release != NULL)
+    {
+        cache_slab_release(cache, release);
+    }
+}
+
+/**
+ * memforge_cache_destroy - Unregisters a cache and releases all its slabs
+ */
+void memforge_cache_destroy(memforge_cache_t *cache)
+{
+    if (cache == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&cache_list_lock);
+    memforge_cache_t **link = &cache_list;
+    while (*link != NULL && *link != cache)
+    {
+        link = &(*link)->next;
+    }
+    if (*link == cache)
+    {
+        *link = cache->next;
+        cache_count--;
+    }
+    pthread_mutex_unlock(&cache_list_lock);
+
+    if (cache->objects_in_use > 0)
+    {
+        debug_log("Cache '%s' destroyed with %zu objects in use", cache->name, cache->objects_in_use);
+    }
+
+    cache_release_list(cache, cache->partial);
+    cache_release_list(cache, cache->full);
+    cache_release_list(cache, cache->empty);
+
+    pthread_mutex_destroy(&cache->lock);
+    system_free_mmap(cache, sizeof(memforge_cache_t));
+}
+
+/**
+ * memforge_cache_get_stats - Copies the occupancy of cache into stats
+ */
+int memforge_cache_get_stats(memforge_cache_t *cache, memforge_cache_stats_t *stats)
+{
+    if (cache == NULL || stats == NULL)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    stats->name = cache->name;
+    stats->object_size = cache->stride;
+    stats->objects_in_use = cache->objects_in_use;
+    stats->objects_cached = cache->objects_cached;
+    stats->object_capacity = cache->slab_count * cache->capacity;
+    stats->slab_count = cache->slab_count;
+    stats->slab_size = cache->slab_size;
+    pthread_mutex_unlock(&cache->lock);
+    return 0;
+}
+
+/**
+ * memforge_get_cache_count - Returns the number of live caches
+ */
+size_t memforge_get_cache_count(void)
+{
+    pthread_mutex_lock(&cache_list_lock);
+    size_t count = cache_count;
+    pthread_mutex_unlock(&cache_list_lock);
+    return count;
+}
+
+/**
+ * memforge_get_cache_stats - Copies the occupancy of the index-th live cache
+ */
+int memforge_get_cache_stats(size_t index, memforge_cache_stats_t *stats)
+{
+    pthread_mutex_lock(&cache_list_lock);
+    memforge_cache_t *cache = cache_list;
+    while (cache != NULL && index-- > 0)
+    {
+        cache = cache->next;
+    }
+    int result = memforge_cache_get_stats(cache, stats);
+    pthread_mutex_unlock(&cache_list_lock);
+    return result;
+}
@@ -0,0 +1,204 @@
+/**
+ * @file purge.c
+ * @brief MemForge background purging of decayed free pages
+ *
+ * Free heap pages are normally purged by the frees that follow them, once
+ * their decay window has passed (see heap_purge()). A program that stops
+ * freeing after a load spike would keep that memory resident, so with
+ * memforge_config_t::purge_thread set a background thread wakes up every
+ * half window and purges every arena in its place.
+ *
+ * @author KyloReneo
+ * @date 2025
+ * @license GPLv3.0
+ */
+
+#include "../../include/memforge/memforge_internal.h"
+
+#include <time.h>
+
+// ============================================================================
+// GLOBAL STATE
+// ============================================================================
+
+/**
+ * @var pthread_t purge_thread
+ * @brief The background purge thread, valid while purge_running is set
+ */
+static pthread_t purge_thread;
+
+/**
+ * @var bool purge_running
+ * @brief Whether the purge thread was started and not yet joined
+ */
+static bool purge_running = false;
+
+/**
+ * @var bool purge_stopping
+ * @brief Asks the purge thread to exit; guarded by purge_lock
+ */
+static bool purge_stopping = false;
+
+/**
+ * @var pthread_mutex_t purge_lock
+ * @brief Guards purge_stopping and the wake-up condition
+ */
+static pthread_mutex_t purge_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @var pthread_cond_t purge_wakeup
+ * @brief Signalled to stop the purge thread before its next round
+ * Waits on CLOCK_MONOTONIC; initialized by purge_thread_start()
+ */
+static pthread_cond_t purge_wakeup;
+
+// ============================================================================
+// PRIVATE HELPER FUNCTIONS
+// ============================================================================
+
+/**
+ * purge_deadline - Absolute CLOCK_MONOTONIC time of the next round, half a
+ * window from now
+ * Rounds are at least a millisecond apart; wall clock steps do not move them
+ */
+static struct timespec purge_deadline(void)
+{
+    size_t ms = memforge_config.purge_decay_ms / 2;
+    if (ms == 0)
+    {
+        ms = 1;
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    // Saturate long windows instead of overflowing time_t
+    size_t max_ms = (size_t)1 << 40;
+    ms = ms < max_ms ? ms : max_ms;
+    deadline.tv_sec += (time_t)(ms / 1000);
+    deadline.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    return deadline;
+}
+
+/**
+ * purge_all_arenas - Purges the decayed pages of every arena
+ */
+static void purge_all_arenas(void)
+{
+    for (size_t i = 0; i < memforge_config.arena_count; i++)
+    {
+        if (memforge_arenas[i] != NULL)
+        {
+            arena_purge(memforge_arenas[i], false);
+        }
+    }
+
+    size_t count = arena_thread_count();
+    for (size_t i = 0; i < count; i++)
+    {
+        memforge_arena_t *arena = arena_thread_at(i);
+        if (arena != NULL)
+        {
+            arena_purge(arena, false);
+        }
+    }
+}
+
+/**
+ * purge_thread_main - Runs a purge round every half decay window until stopped
+ */
+static void *purge_thread_main(void *unused)
+{
+    (void)unused;
+
+    pthread_mutex_lock(&purge_lock);
+    while (!purge_stopping)
+    {
+        struct timespec deadline = purge_deadline();
+        while (!purge_stopping && pthread_cond_timedwait(&purge_wakeup, &purge_lock, &deadline) == 0)
+        {
+            // Spurious wake-up: keep waiting for the same deadline
+        }
+        if (purge_stopping)
+        {
+            break;
+        }
+
+        pthread_mutex_unlock(&purge_lock);
+        purge_all_arenas();
+        pthread_mutex_lock(&purge_lock);
+    }
+    pthread_mutex_unlock(&purge_lock);
+
+    return NULL;
+}
+
+// ============================================================================
+// PURGE THREAD API
+// ============================================================================
+
+/**
+ * purge_thread_start - Creates the purge thread
+ * Nothing decays with a "never" window, so no thread is started then
+ */
+int purge_thread_start(void)
+{
+    if (purge_running || memforge_config.purge_decay_ms == SIZE_MAX)
+    {
+        return 0;
+    }
+
+    pthread_condattr_t attr;
+    if (pthread_condattr_init(&attr) != 0)
+    {
+        return -1;
+    }
+
+    int result = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    if (result == 0)
+    {
+        result = pthread_cond_init(&purge_wakeup, &attr);
+    }
+    pthread_condattr_destroy(&attr);
+    if (result != 0)
+    {
+        return -1;
+    }
+
+    purge_stopping = false;
+    if (pthread_create(&purge_thread, NULL, purge_thread_main, NULL) != 0)
+    {
+        pthread_cond_destroy(&purge_wakeup);
+        return -1;
+    }
+
+    purge_running = true;
+    debug_log("Purge thread started, decay %zu ms", memforge_config.purge_decay_ms);
+    return 0;
+}
+
+/**
+ * purge_thread_stop - Wakes the purge thread up and joins it
+ */
+void purge_thread_stop(void)
+{
+    if (!purge_running)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&purge_lock);
+    purge_stopping = true;
+    pthread_cond_signal(&purge_wakeup);
+    pthread_mutex_unlock(&purge_lock);
+
+    pthread_join(purge_thread, NULL);
+    pthread_cond_destroy(&purge_wakeup);
+    purge_running = false;
+}
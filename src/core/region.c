@@ -0,0 +1,249 @@
+/**
+ * @file region.c
+ * @brief MemForge bump-pointer regions
+ *
+ * A region serves allocations by advancing a pointer through chunks mapped
+ * with system_alloc_mmap(). Nothing is freed individually: a mark records
+ * the current position and a rollback returns to it, which suits scratch
+ * memory with a strictly LIFO lifetime. Rollback and reset keep every chunk
+ * they pass over, so a region that has reached its working size stops
+ * mapping memory altogether.
+ *
+ * Regions are independent of the arenas and not thread-safe.
+ *
+ * @author KyloReneo
+ * @date 2025
+ * @license GPLv3.0
+ */
+
+#include "../../include/memforge/memforge_internal.h"
+
+#include <errno.h>
+#include <stdint.h>
+
+// ============================================================================
+// PRIVATE HELPER FUNCTIONS
+// ============================================================================
+
+/**
+ * region_chunk_data - First byte of a chunk available to allocations
+ * The first chunk also holds the region itself
+ */
+static char *region_chunk_data(const memforge_region_t *region, region_chunk_t *chunk)
+{
+    char *data = (char *)chunk + REGION_CHUNK_OVERHEAD;
+    if (chunk == region->first)
+    {
+        data += MEMFORGE_ALIGN(sizeof(memforge_region_t));
+    }
+
+    return data;
+}
+
+/**
+ * region_enter - Makes chunk the current chunk, starting from its beginning
+ */
+static void region_enter(memforge_region_t *region, region_chunk_t *chunk)
+{
+    region->current = chunk;
+    region->top = region_chunk_data(region, chunk);
+    region->limit = (char *)chunk + chunk->size;
+}
+
+/**
+ * region_chunk_map - Maps a chunk of at least size bytes, header included
+ */
+static region_chunk_t *region_chunk_map(size_t size)
+{
+    size_t page_size = memforge_config.page_size;
+    if (size > SIZE_MAX - page_size)
+    {
+        return NULL;
+    }
+
+    size = (size + page_size - 1) & ~(page_size - 1);
+    region_chunk_t *chunk = system_alloc_mmap(size);
+    if (chunk == NULL)
+    {
+        return NULL;
+    }
+
+    chunk->next = NULL;
+    chunk->size = size;
+    return chunk;
+}
+
+/**
+ * region_grow - Moves to a chunk with room for size bytes
+ * The spare chunk after the current one is reused when it is large
+ * enough; otherwise a new chunk is mapped and linked in before it
+ */
+static bool region_grow(memforge_region_t *region, size_t size)
+{
+    region_chunk_t *spare = region->current->next;
+    if (spare != NULL && size <= spare->size - REGION_CHUNK_OVERHEAD)
+    {
+        region_enter(region, spare);
+        return true;
+    }
+
+    if (size > SIZE_MAX - REGION_CHUNK_OVERHEAD)
+    {
+        return false;
+    }
+
+    size_t needed = REGION_CHUNK_OVERHEAD + size;
+    region_chunk_t *chunk = region_chunk_map(needed > region->chunk_size ? needed : region->chunk_size);
+    if (chunk == NULL)
+    {
+        return false;
+    }
+
+    chunk->next = spare;
+    region->current->next = chunk;
+    region_enter(region, chunk);
+    return true;
+}
+
+// ============================================================================
+// PUBLIC REGION API
+// ============================================================================
+
+/**
+ * memforge_region_create - Maps the first chunk and places the region in it
+ */
+memforge_region_t *memforge_region_create(size_t chunk_size)
+{
+    if (!memforge_initialized && memforge_init(NULL) != 0)
+    {
+        return NULL;
+    }
+
+    if (chunk_size == 0)
+    {
+        chunk_size = MEMFORGE_REGION_CHUNK_SIZE;
+    }
+
+    region_chunk_t *chunk = region_chunk_map(chunk_size);
+    if (chunk == NULL)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    memforge_region_t *region = (memforge_region_t *)((char *)chunk + REGION_CHUNK_OVERHEAD);
+    region->first = chunk;
+    region->chunk_size = chunk->size;
+    region_enter(region, chunk);
+
+    debug_log("Region %p created with %zu-byte chunks", (void *)region, region->chunk_size);
+    return region;
+}
+
+/**
+ * memforge_region_alloc - Bumps the region's pointer by size bytes
+ */
+void *memforge_region_alloc(memforge_region_t *region, size_t size)
+{
+    if (region == NULL)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    if (size > SIZE_MAX / 2)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    size = MEMFORGE_ALIGN(size == 0 ? 1 : size);
+    if ((size_t)(region->limit - region->top) < size && !region_grow(region, size))
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    void *ptr = region->top;
+    region->top += size;
+    return ptr;
+}
+
+/**
+ * memforge_region_mark - Captures the region's current position
+ */
+memforge_region_mark_t memforge_region_mark(memforge_region_t *region)
+{
+    memforge_region_mark_t mark = {NULL, NULL};
+    if (region != NULL)
+    {
+        mark.chunk = region->current;
+        mark.top = region->top;
+    }
+
+    return mark;
+}
+
+/**
+ * memforge_region_rollback - Returns the region to a saved position
+ */
+void memforge_region_rollback(memforge_region_t *region, memforge_region_mark_t mark)
+{
+    if (region == NULL || mark.chunk == NULL)
+    {
+        return;
+    }
+
+    region_chunk_t *chunk = mark.chunk;
+
+#if MEMFORGE_SAFETY_CHECKS
+    // The mark must lie in the filled part of the region, at or before top
+    region_chunk_t *walk = region->first;
+    while (walk != chunk && walk != region->current)
+    {
+        walk = walk->next;
+    }
+    if (walk != chunk || (chunk == region->current && (char *)mark.top > region->top))
+    {
+        debug_log("Stale or foreign mark passed to memforge_region_rollback (region %p)", (void *)region);
+        return;
+    }
+#endif
+
+    region->current = chunk;
+    region->top = mark.top;
+    region->limit = (char *)chunk + chunk->size;
+}
+
+/**
+ * memforge_region_reset - Returns the region to its first byte
+ */
+void memforge_region_reset(memforge_region_t *region)
+{
+    if (region != NULL)
+    {
+        region_enter(region, region->first);
+    }
+}
+
+/**
+ * memforge_region_destroy - Unmaps every chunk, the first (and region) last
+ */
+void memforge_region_destroy(memforge_region_t *region)
+{
+    if (region == NULL)
+    {
+        return;
+    }
+
+    region_chunk_t *first = region->first;
+    region_chunk_t *chunk = first->next;
+    while (chunk != NULL)
+    {
+        region_chunk_t *next = chunk->next;
+        system_free_mmap(chunk, chunk->size);
+        chunk = next;
+    }
+
+    system_free_mmap(first, first->size);
+}
@@ -0,0 +1,137 @@
+/**
+ * @file segment_map.c
+ * @brief MemForge global map from addresses to heap segments
+ *
+ * Heap and slab segments are MEMFORGE_HEAP_SEGMENT_SIZE-aligned, so every
+ * segment occupies exactly one slot of the address space when addresses
+ * are shifted right by MEMFORGE_HEAP_SEGMENT_SHIFT. This module keeps a
+ * two-level radix table over those slots so that memforge_free() can tell
+ * a header-less slab object from a heap block or an mmap'd block without
+ * touching memory that may not be mapped.
+ *
+ * Lookups are lock-free (two dependent loads). Registration only takes a
+ * lock the first time a leaf of the table is needed.
+ *
+ * @author KyloReneo
+ * @date 2025
+ * @license GPLv3.0
+ */
+
+#include "../../include/memforge/memforge_internal.h"
+
+#include <stdatomic.h>
+
+// ============================================================================
+// MAP GEOMETRY
+// ============================================================================
+
+#if UINTPTR_MAX > 0xFFFFFFFFu
+#define SEGMENT_MAP_ADDRESS_BITS 48 // User-space virtual addresses on 64-bit Linux
+#else
+#define SEGMENT_MAP_ADDRESS_BITS 32
+#endif
+
+#define SEGMENT_MAP_KEY_BITS (SEGMENT_MAP_ADDRESS_BITS - MEMFORGE_HEAP_SEGMENT_SHIFT)
+#define SEGMENT_MAP_LEAF_BITS (SEGMENT_MAP_KEY_BITS / 2)
+#define SEGMENT_MAP_ROOT_BITS (SEGMENT_MAP_KEY_BITS - SEGMENT_MAP_LEAF_BITS)
+#define SEGMENT_MAP_LEAF_ENTRIES ((size_t)1 << SEGMENT_MAP_LEAF_BITS)
+#define SEGMENT_MAP_ROOT_ENTRIES ((size_t)1 << SEGMENT_MAP_ROOT_BITS)
+
+typedef _Atomic(heap_segment_t *) segment_map_entry_t;
+
+/**
+ * @var segment_map_root
+ * @brief First level of the map; leaves are mapped on demand
+ */
+static _Atomic(segment_map_entry_t *) segment_map_root[SEGMENT_MAP_ROOT_ENTRIES];
+
+/**
+ * @var pthread_mutex_t segment_map_lock
+ * @brief Serializes creation of leaves
+ */
+static pthread_mutex_t segment_map_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// ============================================================================
+// PRIVATE HELPER FUNCTIONS
+// ============================================================================
+
+/**
+ * segment_map_leaf - Returns the leaf covering key, creating it if asked
+ */
+static segment_map_entry_t *segment_map_leaf(uintptr_t key, bool create)
+{
+    size_t index = (size_t)(key >> SEGMENT_MAP_LEAF_BITS);
+    segment_map_entry_t *leaf = atomic_load_explicit(&segment_map_root[index], memory_order_acquire);
+    if (leaf != NULL || !create)
+    {
+        return leaf;
+    }
+
+    pthread_mutex_lock(&segment_map_lock);
+    leaf = atomic_load_explicit(&segment_map_root[index], memory_order_relaxed);
+    if (leaf == NULL)
+    {
+        // mmap'd memory is zero-filled, i.e. every slot starts out empty
+        leaf = system_alloc_mmap(SEGMENT_MAP_LEAF_ENTRIES * sizeof(segment_map_entry_t));
+        if (leaf != NULL)
+        {
+            atomic_store_explicit(&segment_map_root[index], leaf, memory_order_release);
+        }
+    }
+    pthread_mutex_unlock(&segment_map_lock);
+
+    return leaf;
+}
+
+// ============================================================================
+// SEGMENT MAP API
+// ============================================================================
+
+/**
+ * segment_map_register - Points the map slot of a segment at its tracker
+ */
+int segment_map_register(heap_segment_t *segment)
+{
+    uintptr_t key = (uintptr_t)segment->base >> MEMFORGE_HEAP_SEGMENT_SHIFT;
+    segment_map_entry_t *leaf = segment_map_leaf(key, true);
+    if (leaf == NULL)
+    {
+        return -1;
+    }
+
+    atomic_store_explicit(&leaf[key & (SEGMENT_MAP_LEAF_ENTRIES - 1)], segment, memory_order_release);
+    return 0;
+}
+
+/**
+ * segment_map_unregister - Clears the map slot of a segment
+ */
+void segment_map_unregister(heap_segment_t *segment)
+{
+    uintptr_t key = (uintptr_t)segment->base >> MEMFORGE_HEAP_SEGMENT_SHIFT;
+    segment_map_entry_t *leaf = segment_map_leaf(key, false);
+    if (leaf != NULL)
+    {
+        atomic_store_explicit(&leaf[key & (SEGMENT_MAP_LEAF_ENTRIES - 1)], NULL, memory_order_release);
+    }
+}
+
+/**
+ * segment_map_lookup - Finds the segment that contains ptr, if any
+ */
+heap_segment_t *segment_map_lookup(const void *ptr)
+{
+    uintptr_t key = (uintptr_t)ptr >> MEMFORGE_HEAP_SEGMENT_SHIFT;
+    if ((key >> SEGMENT_MAP_KEY_BITS) != 0)
+    {
+        return NULL; // Outside the address range the map covers
+    }
+
+    segment_map_entry_t *leaf = segment_map_leaf(key, false);
+    if (leaf == NULL)
+    {
+        return NULL;
+    }
+
+    return atomic_load_explicit(&leaf[key & (SEGMENT_MAP_LEAF_ENTRIES - 1)], memory_order_acquire);
+}
@@ -0,0 +1,149 @@
+/**
+ * @file size_class.c
+ * @brief MemForge size class resolution
+ *
+ * Maps request sizes onto memforge_size_classes without scanning the class
+ * table. Two lookup tables are derived from the class table at
+ * initialization:
+ * - A byte-granular table (one entry per MEMFORGE_ALIGNMENT bytes) for
+ *   sizes up to MEMFORGE_SMALL_LOOKUP_MAX
+ * - A table indexed by floor(log2(size - 1)) and the next
+ *   MEMFORGE_SIZE_CLASS_LOOKUP_BITS bits below it for everything larger
+ *
+ * Because both tables are generated from memforge_size_classes, the class
+ * table can be changed at build time without touching this module.
+ *
+ * @author KyloReneo
+ * @date 2025
+ * @license GPLv3.0
+ */
+
+#include "../../include/memforge/memforge_internal.h"
+
+// ============================================================================
+// LOOKUP TABLES
+// ============================================================================
+
+_Static_assert(MEMFORGE_SIZE_CLASS_COUNT < UINT8_MAX, "size class indices must fit in uint8_t");
+_Static_assert((MEMFORGE_SMALL_LOOKUP_MAX & (MEMFORGE_SMALL_LOOKUP_MAX - 1)) == 0,
+               "MEMFORGE_SMALL_LOOKUP_MAX must be a power of two");
+
+#define SIZE_BITS (sizeof(size_t) * 8)
+#define SMALL_LOOKUP_ENTRIES (MEMFORGE_SMALL_LOOKUP_MAX / MEMFORGE_ALIGNMENT + 1)
+#define LARGE_LOOKUP_CELLS (1u << MEMFORGE_SIZE_CLASS_LOOKUP_BITS)
+#define LARGE_LOOKUP_ENTRIES (SIZE_BITS * LARGE_LOOKUP_CELLS)
+
+/**
+ * @var uint8_t small_class_lookup[]
+ * @brief Class index for sizes in ((i - 1) * MEMFORGE_ALIGNMENT, i * MEMFORGE_ALIGNMENT]
+ */
+static uint8_t small_class_lookup[SMALL_LOOKUP_ENTRIES];
+
+/**
+ * @var uint8_t large_class_lookup[]
+ * @brief Class index for the smallest size of each (log2, mantissa) cell
+ */
+static uint8_t large_class_lookup[LARGE_LOOKUP_ENTRIES];
+
+// ============================================================================
+// PRIVATE HELPER FUNCTIONS
+// ============================================================================
+
+/**
+ * floor_log2 - Index of the highest set bit of x (x must be non-zero)
+ */
+static inline size_t floor_log2(size_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (sizeof(unsigned long long) * 8 - 1) - (size_t)__builtin_clzll((unsigned long long)x);
+#else
+    size_t log = 0;
+    while (x >>= 1)
+    {
+        log++;
+    }
+    return log;
+#endif
+}
+
+/**
+ * size_class_scan - Reference lookup by linear scan (initialization only)
+ */
+static size_t size_class_scan(size_t size)
+{
+    for (size_t i = 0; i < MEMFORGE_SIZE_CLASS_COUNT; i++)
+    {
+        if (size <= memforge_size_classes[i])
+        {
+            return i;
+        }
+    }
+
+    return MEMFORGE_SIZE_CLASS_COUNT;
+}
+
+// ============================================================================
+// SIZE CLASS API
+// ============================================================================
+
+/**
+ * size_class_init - Derives both lookup tables from memforge_size_classes
+ */
+void size_class_init(void)
+{
+    for (size_t i = 0; i < SMALL_LOOKUP_ENTRIES; i++)
+    {
+        small_class_lookup[i] = (uint8_t)size_class_scan(i * MEMFORGE_ALIGNMENT);
+    }
+
+    // Cell (lg, sub) covers sizes whose (size - 1) has its top bit at lg and
+    // the next MEMFORGE_SIZE_CLASS_LOOKUP_BITS bits equal to sub
+    size_t first_lg = floor_log2(MEMFORGE_SMALL_LOOKUP_MAX);
+    for (size_t lg = first_lg; lg < SIZE_BITS; lg++)
+    {
+        size_t cell_size = (size_t)1 << (lg - MEMFORGE_SIZE_CLASS_LOOKUP_BITS);
+        for (size_t sub = 0; sub < LARGE_LOOKUP_CELLS; sub++)
+        {
+            size_t smallest = ((size_t)1 << lg) + sub * cell_size + 1;
+            large_class_lookup[(lg << MEMFORGE_SIZE_CLASS_LOOKUP_BITS) | sub] = (uint8_t)size_class_scan(smallest);
+        }
+    }
+}
+
+/**
+ * get_size_class - Resolves the smallest class holding size in O(1)
+ */
+size_t get_size_class(size_t size)
+{
+    if (size <= MEMFORGE_SMALL_LOOKUP_MAX)
+    {
+        return small_class_lookup[(size + MEMFORGE_ALIGNMENT - 1) / MEMFORGE_ALIGNMENT];
+    }
+
+    size_t bits = size - 1;
+    size_t lg = floor_log2(bits);
+    size_t cell = (bits >> (lg - MEMFORGE_SIZE_CLASS_LOOKUP_BITS)) & (LARGE_LOOKUP_CELLS - 1);
+    size_t size_class = large_class_lookup[(lg << MEMFORGE_SIZE_CLASS_LOOKUP_BITS) | cell];
+
+    // A class boundary inside the cell means the upper part belongs to the next class
+    while (size_class < MEMFORGE_SIZE_CLASS_COUNT && memforge_size_classes[size_class] < size)
+    {
+        size_class++;
+    }
+
+    return size_class;
+}
+
+/**
+ * get_size_class_floor - Resolves the largest class that size fully covers
+ */
+size_t get_size_class_floor(size_t size)
+{
+    size_t size_class = get_size_class(size);
+    if (size_class == MEMFORGE_SIZE_CLASS_COUNT || memforge_size_classes[size_class] > size)
+    {
+        return size_class > 0 ? size_class - 1 : 0;
+    }
+
+    return size_class;
+}
@@ -0,0 +1,334 @@
+/**
+ * @file slab.c
+ * @brief MemForge header-less slab allocator for small size classes
+ *
+ * Size classes up to MEMFORGE_SLAB_MAX_SIZE are served from runs: page-sized
+ * chunks of a slab segment that hold objects of one class back to back.
+ * Objects carry no block header; the run they belong to is found by masking
+ * the object address down to its segment and indexing the run descriptors
+ * stored at the segment base. This removes the per-object header that would
+ * otherwise more than double the footprint of 16- and 32-byte objects.
+ *
+ * Every function that takes an arena expects the caller to hold its lock.
+ *
+ * @author KyloReneo
+ * @date 2025
+ * @license GPLv3.0
+ */
+
+#include "../../include/memforge/memforge_internal.h"
+
+#include <string.h>
+
+// ============================================================================
+// SLAB GEOMETRY
+// ============================================================================
+
+_Static_assert(MEMFORGE_SLAB_MAX_SIZE <= MEMFORGE_SLAB_RUN_SIZE / 4, "slab runs must hold several objects");
+_Static_assert(SLAB_RUN_OBJECTS_MAX <= 0xFFFF, "object counts must fit in unsigned short");
+
+#define SLAB_RUNS_PER_SEGMENT (MEMFORGE_HEAP_SEGMENT_SIZE / MEMFORGE_SLAB_RUN_SIZE)
+#define SLAB_METADATA_RUNS ((sizeof(slab_segment_t) + MEMFORGE_SLAB_RUN_SIZE - 1) / MEMFORGE_SLAB_RUN_SIZE)
+
+// ============================================================================
+// PRIVATE HELPER FUNCTIONS
+// ============================================================================
+
+/**
+ * slab_run_link - Makes run the first partial run of its class
+ */
+static void slab_run_link(memforge_arena_t *arena, slab_run_t *run)
+{
+    run->prev = NULL;
+    run->next = arena->slab_runs[run->size_class];
+    if (run->next != NULL)
+    {
+        run->next->prev = run;
+    }
+    arena->slab_runs[run->size_class] = run;
+}
+
+/**
+ * slab_run_unlink - Removes run from its class's partial list
+ */
+static void slab_run_unlink(memforge_arena_t *arena, slab_run_t *run)
+{
+    if (run->prev != NULL)
+    {
+        run->prev->next = run->next;
+    }
+    else
+    {
+        arena->slab_runs[run->size_class] = run->next;
+    }
+
+    if (run->next != NULL)
+    {
+        run->next->prev = run->prev;
+    }
+
+    run->next = NULL;
+    run->prev = NULL;
+}
+
+/**
+ * slab_segment_create - Maps a slab segment and pools its runs in the arena
+ */
+static bool slab_segment_create(memforge_arena_t *arena)
+{
+    heap_segment_t *segment = heap_segment_map(arena, HEAP_SEGMENT_SLAB);
+    if (segment == NULL)
+    {
+        return false;
+    }
+
+    char *base = segment->base;
+
+    // Pool the runs past the metadata area, lowest address first
+    slab_segment_t *slab = (slab_segment_t *)segment;
+    for (size_t i = SLAB_RUNS_PER_SEGMENT; i > SLAB_METADATA_RUNS; i--)
+    {
+        slab_run_t *run = &slab->runs[i - 1];
+        run->base = base + (i - 1) * MEMFORGE_SLAB_RUN_SIZE;
+        run->next = arena->slab_free_runs;
+        arena->slab_free_runs = run;
+    }
+
+    debug_log("Arena %p grew by slab segment %p", (void *)arena, (void *)base);
+    return true;
+}
+
+/**
+ * slab_run_assign - Dedicates an unassigned run to a size class
+ */
+static slab_run_t *slab_run_assign(memforge_arena_t *arena, size_t size_class)
+{
+    if (arena->slab_free_runs == NULL && !slab_segment_create(arena))
+    {
+        return NULL;
+    }
+
+    slab_run_t *run = arena->slab_free_runs;
+    arena->slab_free_runs = run->next;
+
+    run->free_objects = NULL;
+    run->object_size = (unsigned int)memforge_size_classes[size_class];
+    run->capacity = (unsigned short)(MEMFORGE_SLAB_RUN_SIZE / run->object_size);
+    run->carved = 0;
+    run->used = 0;
+    run->size_class = (unsigned char)size_class;
+#if MEMFORGE_SAFETY_CHECKS
+    memset(run->live, 0, sizeof(run->live));
+#endif
+
+    slab_run_link(arena, run);
+    return run;
+}
+
+// ============================================================================
+// SLAB API
+// ============================================================================
+
+/**
+ * slab_run_of - Locates the descriptor of the run containing ptr
+ */
+slab_run_t *slab_run_of(const void *ptr)
+{
+    slab_segment_t *slab = (slab_segment_t *)HEAP_SEGMENT_OF(ptr);
+    size_t index = ((uintptr_t)ptr & (MEMFORGE_HEAP_SEGMENT_SIZE - 1)) / MEMFORGE_SLAB_RUN_SIZE;
+    return &slab->runs[index];
+}
+
+/**
+ * slab_alloc_object - Takes one object from the first partial run of a class
+ * Recycled objects are preferred over carving untouched ones, which keeps
+ * the run's working set small
+ */
+void *slab_alloc_object(memforge_arena_t *arena, size_t size_class)
+{
+    slab_run_t *run = arena->slab_runs[size_class];
+    if (run == NULL)
+    {
+        run = slab_run_assign(arena, size_class);
+        if (run == NULL)
+        {
+            return NULL;
+        }
+    }
+
+    char *object;
+    if (run->free_objects != NULL)
+    {
+        object = run->free_objects;
+        run->free_objects = *(void **)object;
+    }
+    else
+    {
+        object = run->base + (size_t)run->carved * run->object_size;
+        run->carved++;
+    }
+    run->used++;
+
+#if MEMFORGE_SAFETY_CHECKS
+    size_t index = (size_t)(object - run->base) / run->object_size;
+    run->live[index / 64] |= (uint64_t)1 << (index % 64);
+#endif
+
+    if (run->used == run->capacity)
+    {
+        slab_run_unlink(arena, run); // Full runs leave the partial list
+    }
+
+    return object;
+}
+
+/**
+ * slab_free_object - Pushes an object back onto its run
+ */
+bool slab_free_object(memforge_arena_t *arena, void *ptr)
+{
+    slab_run_t *run = slab_run_of(ptr);
+
+#if MEMFORGE_SAFETY_CHECKS
+    size_t offset = (size_t)((char *)ptr - run->base);
+    size_t index = run->object_size != 0 ? offset / run->object_size : 0;
+    if (run->object_size == 0 || offset % run->object_size != 0 || index >= run->carved ||
+        (run->live[index / 64] & ((uint64_t)1 << (index % 64))) == 0)
+    {
+        return false;
+    }
+    run->live[index / 64] &= ~((uint64_t)1 << (index % 64));
+#endif
+
+    bool was_full = run->used == run->capacity;
+
+    *(void **)ptr = run->free_objects;
+    run->free_objects = ptr;
+    run->used--;
+
+    if (was_full)
+    {
+        slab_run_link(arena, run);
+    }
+    else if (run->used == 0 && (arena->slab_runs[run->size_class] != run || run->next != NULL))
+    {
+        // Empty and not the class's last partial run: give the run back to the pool
+        slab_run_unlink(arena, run);
+        run->next = arena->slab_free_runs;
+        arena->slab_free_runs = run;
+    }
+
+    return true;
+}
+
+/**
+ * slab_run_dirty_bytes - Pages of a run that objects were ever carved from
+ */
+static size_t slab_run_dirty_bytes(const slab_run_t *run)
+{
+    size_t page_size = memforge_config.page_size;
+    size_t touched = ((size_t)run->carved * run->object_size + page_size - 1) & ~(page_size - 1);
+    return touched < MEMFORGE_SLAB_RUN_SIZE ? touched : MEMFORGE_SLAB_RUN_SIZE;
+}
+
+/**
+ * slab_segment_is_empty - Whether no run of a slab segment holds an object
+ * Cached objects count as allocated, so their runs keep the segment alive
+ */
+static bool slab_segment_is_empty(slab_segment_t *slab)
+{
+    for (size_t i = SLAB_METADATA_RUNS; i < SLAB_RUNS_PER_SEGMENT; i++)
+    {
+        if (slab->runs[i].used != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * slab_trim - Returns the memory of empty slab runs and segments
+ * Empty partial runs are pooled first, even the last one of their class.
+ * Segments whose runs are all empty then leave the pool and are unmapped,
+ * and the pages of the remaining pooled runs that were ever carved are
+ * purged. Only bytes that may have been resident are counted
+ */
+size_t slab_trim(memforge_arena_t *arena)
+{
+    size_t released = 0;
+    size_t purged = 0;
+
+    for (size_t i = 0; i < MEMFORGE_SIZE_CLASS_COUNT; i++)
+    {
+        slab_run_t *run = arena->slab_runs[i];
+        while (run != NULL)
+        {
+            slab_run_t *next = run->next;
+            if (run->used == 0)
+            {
+                slab_run_unlink(arena, run);
+                run->next = arena->slab_free_runs;
+                arena->slab_free_runs = run;
+            }
+            run = next;
+        }
+    }
+
+    // Unlink the empty segments; their runs are still pooled
+    heap_segment_t *doomed = NULL;
+    heap_segment_t **link = &arena->heap_segments;
+    while (*link != NULL)
+    {
+        heap_segment_t *segment = *link;
+        if (segment->kind == HEAP_SEGMENT_SLAB && slab_segment_is_empty((slab_segment_t *)segment))
+        {
+            *link = segment->next;
+            segment->next = doomed;
+            doomed = segment;
+            continue;
+        }
+        link = &segment->next;
+    }
+
+    slab_run_t **pooled = &arena->slab_free_runs;
+    while (*pooled != NULL)
+    {
+        slab_run_t *run = *pooled;
+        heap_segment_t *owner = HEAP_SEGMENT_OF(run->base);
+
+        heap_segment_t *segment = doomed;
+        while (segment != NULL && segment != owner)
+        {
+            segment = segment->next;
+        }
+
+        if (segment != NULL)
+        {
+            released += slab_run_dirty_bytes(run);
+            *pooled = run->next;
+            continue;
+        }
+
+        if (run->carved != 0 && system_purge_pages(run->base, slab_run_dirty_bytes(run)) == 0)
+        {
+            purged += slab_run_dirty_bytes(run);
+            run->carved = 0;
+        }
+        pooled = &run->next;
+    }
+
+    while (doomed != NULL)
+    {
+        heap_segment_t *next = doomed->next;
+        size_t page_size = memforge_config.page_size;
+        released += (sizeof(slab_segment_t) + page_size - 1) & ~(page_size - 1); // Descriptors
+        debug_log("Arena %p released slab segment %p", (void *)arena, doomed->base);
+        heap_segment_destroy(doomed);
+        doomed = next;
+    }
+
+    STATS_ADD(purged_bytes, purged);
+    return released + purged;
+}
@@ -0,0 +1,358 @@
+/**
+ * @file stats.c
+ * @brief MemForge statistics reporting
+ *
+ * Counters are kept in per-thread shards (see stats_shard_t) so that the
+ * allocation paths never write a cache line shared with other threads;
+ * the public accessors sum the shards on demand. Building with
+ * MEMFORGE_STATS=0 removes every counter update.
+ *
+ * @author KyloReneo
+ * @date 2025
+ * @license GPLv3.0
+ */
+
+#include "../../include/memforge/memforge_internal.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// GLOBAL STATE
+// ============================================================================
+
+/**
+ * @var stats_shard_t* stats_thread_shard
+ * @brief The calling thread's shard
+ */
+_Thread_local stats_shard_t *stats_thread_shard = NULL;
+
+/**
+ * @var stats_shard_t* stats_shards
+ * @brief Every shard ever mapped, owned or not
+ */
+static stats_shard_t *stats_shards = NULL;
+
+/**
+ * @var stats_shard_t* stats_shard_pool
+ * @brief Shards released by exited threads
+ */
+static stats_shard_t *stats_shard_pool = NULL;
+
+/**
+ * @var size_t stats_peak_usage
+ * @brief Highest aggregated usage observed so far
+ */
+static size_t stats_peak_usage = 0;
+
+/**
+ * @var pthread_mutex_t stats_shard_lock
+ * @brief Protects the shard lists and stats_peak_usage
+ */
+static pthread_mutex_t stats_shard_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @var pthread_key_t stats_shard_key
+ * @brief Key whose destructor releases a thread's shard when it exits
+ */
+static pthread_key_t stats_shard_key;
+
+/**
+ * @var pthread_once_t stats_shard_key_once
+ * @brief Guards one-time creation of stats_shard_key
+ */
+static pthread_once_t stats_shard_key_once = PTHREAD_ONCE_INIT;
+
+// ============================================================================
+// PRIVATE HELPER FUNCTIONS
+// ============================================================================
+
+/**
+ * stats_shard_release - Returns an exiting thread's shard to the pool
+ * A later update from another destructor of the same thread simply
+ * acquires a shard again
+ */
+static void stats_shard_release(void *arg)
+{
+    stats_shard_t *shard = arg;
+    stats_thread_shard = NULL;
+
+    pthread_mutex_lock(&stats_shard_lock);
+    shard->pool_next = stats_shard_pool;
+    stats_shard_pool = shard;
+    pthread_mutex_unlock(&stats_shard_lock);
+}
+
+/**
+ * stats_shard_key_create - Creates the thread-exit key (runs once)
+ */
+static void stats_shard_key_create(void)
+{
+    pthread_key_create(&stats_shard_key, stats_shard_release);
+}
+
+/**
+ * stats_read - Loads a counter another thread may be updating
+ */
+static size_t stats_read(const size_t *counter)
+{
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+/**
+ * stats_clamp_usage - Maps a summed usage that wrapped below zero to 0
+ * Shards are read one after the other, so a free counted in one shard can
+ * be seen without the matching allocation counted in another
+ */
+static size_t stats_clamp_usage(size_t usage)
+{
+    return (ptrdiff_t)usage < 0 ? 0 : usage;
+}
+
+#if MEMFORGE_STATS
+/**
+ * stats_current_usage - Sums current_usage over every shard
+ * Caller holds stats_shard_lock
+ */
+static size_t stats_current_usage(void)
+{
+    size_t usage = 0;
+    for (stats_shard_t *shard = stats_shards; shard != NULL; shard = shard->next)
+    {
+        usage += stats_read(&shard->counters.current_usage);
+    }
+
+    return stats_clamp_usage(usage);
+}
+#endif
+
+/**
+ * stats_update_peak - Raises the recorded peak to usage if it is higher
+ * Caller holds stats_shard_lock
+ */
+static size_t stats_update_peak(size_t usage)
+{
+    if (usage > stats_peak_usage)
+    {
+        stats_peak_usage = usage;
+    }
+
+    return stats_peak_usage;
+}
+
+// ============================================================================
+// STATISTICS SHARDS
+// ============================================================================
+
+/**
+ * stats_shard_acquire - Gives the calling thread a pooled or fresh shard
+ */
+stats_shard_t *stats_shard_acquire(void)
+{
+    pthread_once(&stats_shard_key_once, stats_shard_key_create);
+
+    pthread_mutex_lock(&stats_shard_lock);
+    stats_shard_t *shard = stats_shard_pool;
+    if (shard != NULL)
+    {
+        stats_shard_pool = shard->pool_next;
+    }
+    pthread_mutex_unlock(&stats_shard_lock);
+
+    if (shard == NULL)
+    {
+        shard = system_alloc_mmap(sizeof(stats_shard_t)); // Zero-filled
+        if (shard == NULL)
+        {
+            return NULL;
+        }
+
+        pthread_mutex_lock(&stats_shard_lock);
+        shard->next = stats_shards;
+        stats_shards = shard;
+        pthread_mutex_unlock(&stats_shard_lock);
+    }
+
+    pthread_setspecific(stats_shard_key, shard);
+    stats_thread_shard = shard;
+    return shard;
+}
+
+/**
+ * stats_observe_peak - Samples the aggregated usage into the peak
+ */
+void stats_observe_peak(void)
+{
+#if MEMFORGE_STATS
+    pthread_mutex_lock(&stats_shard_lock);
+    stats_update_peak(stats_current_usage());
+    pthread_mutex_unlock(&stats_shard_lock);
+#endif
+}
+
+/**
+ * stats_reset - Zeroes every shard and the recorded peak
+ */
+void stats_reset(void)
+{
+    pthread_mutex_lock(&stats_shard_lock);
+    for (stats_shard_t *shard = stats_shards; shard != NULL; shard = shard->next)
+    {
+        memset(&shard->counters, 0, sizeof(shard->counters));
+    }
+    stats_peak_usage = 0;
+    pthread_mutex_unlock(&stats_shard_lock);
+}
+
+// ============================================================================
+// PUBLIC STATISTICS API
+// ============================================================================
+
+/**
+ * memforge_get_stats - Sums every shard into stats
+ * Counters of threads still running may be mid-update, so the snapshot is
+ * only exact once the allocator is quiescent
+ */
+void memforge_get_stats(memforge_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+
+    pthread_mutex_lock(&stats_shard_lock);
+    for (stats_shard_t *shard = stats_shards; shard != NULL; shard = shard->next)
+    {
+        const memforge_stats_t *counters = &shard->counters;
+        stats->total_allocated += stats_read(&counters->total_allocated);
+        stats->total_freed += stats_read(&counters->total_freed);
+        stats->current_usage += stats_read(&counters->current_usage);
+        stats->allocation_count += stats_read(&counters->allocation_count);
+        stats->free_count += stats_read(&counters->free_count);
+        stats->mmap_count += stats_read(&counters->mmap_count);
+        stats->mmap_cache_hits += stats_read(&counters->mmap_cache_hits);
+        stats->heap_expansions += stats_read(&counters->heap_expansions);
+        stats->thread_cache_hits += stats_read(&counters->thread_cache_hits);
+        stats->thread_cache_misses += stats_read(&counters->thread_cache_misses);
+        stats->remote_frees += stats_read(&counters->remote_frees);
+        stats->remote_free_drains += stats_read(&counters->remote_free_drains);
+        stats->arena_migrations += stats_read(&counters->arena_migrations);
+        stats->huge_page_bytes += stats_read(&counters->huge_page_bytes);
+        stats->purged_bytes += stats_read(&counters->purged_bytes);
+        stats->realloc_in_place += stats_read(&counters->realloc_in_place);
+        stats->realloc_moved += stats_read(&counters->realloc_moved);
+
+        for (size_t i = 0; i < MEMFORGE_SIZE_CLASS_COUNT; i++)
+        {
+            stats->class_requested[i] += stats_read(&counters->class_requested[i]);
+            stats->class_allocated[i] += stats_read(&counters->class_allocated[i]);
+        }
+    }
+    stats->current_usage = stats_clamp_usage(stats->current_usage);
+    stats->peak_usage = stats_update_peak(stats->current_usage);
+    pthread_mutex_unlock(&stats_shard_lock);
+}
+
+/**
+ * memforge_get_arena_count - Returns the number of arenas in use
+ * Shared arenas come first, followed by per-thread arenas
+ */
+size_t memforge_get_arena_count(void)
+{
+    return memforge_initialized ? memforge_config.arena_count + arena_thread_count() : 0;
+}
+
+/**
+ * memforge_get_arena_stats - Copies the counters of arena index into stats
+ */
+int memforge_get_arena_stats(size_t index, memforge_arena_stats_t *stats)
+{
+    if (stats == NULL || !memforge_initialized)
+    {
+        return -1;
+    }
+
+    memforge_arena_t *arena = index < memforge_config.arena_count
+                                  ? memforge_arenas[index]
+                                  : arena_thread_at(index - memforge_config.arena_count);
+    return memforge_arena_get_stats(arena, stats);
+}
+
+/**
+ * memforge_arena_get_stats - Copies the counters of arena into stats
+ */
+int memforge_arena_get_stats(memforge_arena_t *arena, memforge_arena_stats_t *stats)
+{
+    if (arena == NULL || stats == NULL)
+    {
+        return -1;
+    }
+
+    stats->allocated = arena->allocated;
+    stats->freed = arena->freed;
+    stats->lock_acquisitions = arena->lock_acquisitions;
+    stats->lock_contentions = atomic_load_explicit(&arena->lock_contentions, memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * memforge_malloc_stats - Prints a summary of the allocator statistics to stdout
+ * Size classes that served at least one allocation are listed with their
+ * internal fragmentation (share of handed-out bytes that was not requested)
+ */
+void memforge_malloc_stats(void)
+{
+    memforge_stats_t stats;
+    memforge_get_stats(&stats);
+
+    printf("MemForge statistics\n");
+    printf("  total allocated : %zu bytes\n", stats.total_allocated);
+    printf("  total freed     : %zu bytes\n", stats.total_freed);
+    printf("  in use          : %zu bytes (peak %zu)\n", stats.current_usage, stats.peak_usage);
+    printf("  malloc / free   : %zu / %zu\n", stats.allocation_count, stats.free_count);
+    printf("  mmap allocations: %zu (%zu reused from the extent cache)\n", stats.mmap_count, stats.mmap_cache_hits);
+    printf("  mmap threshold  : %zu bytes%s\n", memforge_get_mmap_threshold(),
+           memforge_config.mmap_threshold_fixed ? "" : " (adaptive)");
+    printf("  heap expansions : %zu\n", stats.heap_expansions);
+    printf("  thread cache    : %zu hits, %zu misses\n", stats.thread_cache_hits, stats.thread_cache_misses);
+    printf("  remote frees    : %zu (%zu drains)\n", stats.remote_frees, stats.remote_free_drains);
+    printf("  arena migrations: %zu\n", stats.arena_migrations);
+    printf("  huge page bytes : %zu\n", stats.huge_page_bytes);
+    printf("  purged bytes    : %zu\n", stats.purged_bytes);
+    printf("  realloc         : %zu in place, %zu moved\n", stats.realloc_in_place, stats.realloc_moved);
+
+    for (size_t i = 0; i < memforge_get_arena_count(); i++)
+    {
+        memforge_arena_stats_t arena;
+        if (memforge_get_arena_stats(i, &arena) == 0)
+        {
+            printf("  arena %-9zu : %zu locks, %zu contended\n", i, arena.lock_acquisitions, arena.lock_contentions);
+        }
+    }
+
+    for (size_t i = 0; i < memforge_get_cache_count(); i++)
+    {
+        memforge_cache_stats_t cache;
+        if (memforge_get_cache_stats(i, &cache) == 0)
+        {
+            printf("  cache %-9s : %zu in use, %zu cached, %zu slabs of %zu bytes\n", cache.name, cache.objects_in_use,
+                   cache.objects_cached, cache.slab_count, cache.slab_size);
+        }
+    }
+
+    printf("  %10s %14s %14s %8s\n", "class", "requested", "allocated", "waste");
+    for (size_t i = 0; i < MEMFORGE_SIZE_CLASS_COUNT; i++)
+    {
+        if (stats.class_allocated[i] == 0)
+        {
+            continue;
+        }
+
+        double waste = 100.0 * (double)(stats.class_allocated[i] - stats.class_requested[i]) /
+                       (double)stats.class_allocated[i];
+        printf("  %10zu %14zu %14zu %7.1f%%\n", memforge_size_classes[i], stats.class_requested[i],
+               stats.class_allocated[i], waste);
+    }
+}
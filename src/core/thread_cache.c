@@ -0,0 +1,179 @@
+/**
+ * @file thread_cache.c
+ * @brief MemForge per-thread cache of recently freed blocks
+ *
+ * Small slab objects and heap blocks freed by a thread are parked in a
+ * thread-local LIFO per size class and handed straight back to the next
+ * allocation of that class. The common malloc/free pair therefore never
+ * takes an arena lock. Each bin is bounded by memforge_config.thread_cache_size;
+ * when it overflows, the older half is returned to the owning arenas in one
+ * batch, and everything left is returned when the thread exits.
+ *
+ * When per-CPU caches are enabled (cpu_cache.c), both entry points forward
+ * to them and the thread-local bins stay empty, so cache memory remains
+ * bounded by the core count. A thread that cannot use rseq then frees
+ * straight to its arena.
+ *
+ * @author KyloReneo
+ * @date 2025
+ * @license GPLv3.0
+ */
+
+#include "../../include/memforge/memforge_internal.h"
+
+// ============================================================================
+// THREAD-LOCAL STATE
+// ============================================================================
+
+/**
+ * @var thread_cache_t thread_cache
+ * @brief The calling thread's cache
+ */
+static _Thread_local thread_cache_t thread_cache = {0};
+
+/**
+ * @var pthread_key_t thread_cache_key
+ * @brief Key whose destructor flushes a thread's cache when it exits
+ */
+static pthread_key_t thread_cache_key;
+
+/**
+ * @var pthread_once_t thread_cache_key_once
+ * @brief Guards one-time creation of thread_cache_key
+ */
+static pthread_once_t thread_cache_key_once = PTHREAD_ONCE_INIT;
+
+// ============================================================================
+// PRIVATE HELPER FUNCTIONS
+// ============================================================================
+
+/**
+ * thread_cache_destructor - Returns an exiting thread's cached blocks
+ */
+static void thread_cache_destructor(void *arg)
+{
+    (void)arg;
+    thread_cache_flush();
+}
+
+/**
+ * thread_cache_key_create - Creates the thread-exit key (runs once)
+ */
+static void thread_cache_key_create(void)
+{
+    pthread_key_create(&thread_cache_key, thread_cache_destructor);
+}
+
+/**
+ * thread_cache_register - Arms the thread-exit flush for the calling thread
+ * Only the first free of each thread gets here
+ */
+static void thread_cache_register(void)
+{
+    pthread_once(&thread_cache_key_once, thread_cache_key_create);
+    pthread_setspecific(thread_cache_key, &thread_cache);
+    thread_cache.registered = true;
+}
+
+// ============================================================================
+// THREAD CACHE API
+// ============================================================================
+
+/**
+ * thread_cache_alloc - Pops the most recently freed entry of a size class
+ */
+void *thread_cache_alloc(size_t size_class)
+{
+    if (memforge_config.cpu_cache_enabled)
+    {
+        void *object;
+        return cpu_cache_alloc(size_class, &object) ? object : NULL;
+    }
+
+    thread_cache_entry_t *entry = thread_cache.bins[size_class];
+    if (entry == NULL)
+    {
+        return NULL;
+    }
+
+    thread_cache.bins[size_class] = entry->next;
+    thread_cache.counts[size_class]--;
+    return entry;
+}
+
+/**
+ * thread_cache_free - Pushes a freed object onto the calling thread's cache
+ */
+bool thread_cache_free(void *ptr, size_t size_class)
+{
+    size_t limit = memforge_config.thread_cache_size;
+    if (!THREAD_CACHE_ACTIVE() || limit == 0 || memforge_size_classes[size_class] > MEMFORGE_THREAD_CACHE_MAX_SIZE)
+    {
+        return false;
+    }
+
+    if (memforge_config.cpu_cache_enabled)
+    {
+        return cpu_cache_free(ptr, size_class);
+    }
+
+    if (!thread_cache.registered)
+    {
+        thread_cache_register();
+    }
+
+    if (thread_cache.counts[size_class] >= limit)
+    {
+        // Keep the newest (cache-hot) half, return the older half in one batch
+        size_t keep = limit / 2;
+        thread_cache_entry_t *released = thread_cache.bins[size_class];
+
+        if (keep == 0)
+        {
+            thread_cache.bins[size_class] = NULL;
+        }
+        else
+        {
+            thread_cache_entry_t *last = released;
+            for (size_t i = 1; i < keep; i++)
+            {
+                last = last->next;
+            }
+            released = last->next;
+            last->next = NULL;
+        }
+
+        thread_cache.counts[size_class] = keep;
+        arena_release_chain(released);
+    }
+
+    thread_cache_entry_t *entry = ptr;
+
+#if MEMFORGE_SAFETY_CHECKS
+    if (thread_cache.bins[size_class] == entry)
+    {
+        // Immediate double free: pushing it again would make the bin a cycle
+        debug_log("Double free detected at %p", ptr);
+        return true;
+    }
+#endif
+
+    entry->next = thread_cache.bins[size_class];
+    thread_cache.bins[size_class] = entry;
+    thread_cache.counts[size_class]++;
+    return true;
+}
+
+/**
+ * thread_cache_flush - Empties every bin of the calling thread's cache
+ */
+void thread_cache_flush(void)
+{
+    for (size_t i = 0; i < MEMFORGE_SIZE_CLASS_COUNT; i++)
+    {
+        thread_cache_entry_t *entry = thread_cache.bins[i];
+        thread_cache.bins[i] = NULL;
+        thread_cache.counts[i] = 0;
+        arena_release_chain(entry);
+    }
+}
@@ -0,0 +1,69 @@
+/**
+ * @file utils.c
+ * @brief MemForge internal utilities
+ *
+ * Small helpers shared by the allocator modules: debug logging and
+ * power-of-two arithmetic.
+ *
+ * @author KyloReneo
+ * @date 2025
+ * @license GPLv3.0
+ */
+
+#include "../../include/memforge/memforge_internal.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+// ============================================================================
+// DEBUG LOGGING
+// ============================================================================
+
+/**
+ * debug_log - Prints a printf-style message to stderr when debugging is enabled
+ */
+void debug_log(const char *format, ...)
+{
+    if (!memforge_config.debug_enabled)
+    {
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    fputs("[MemForge] ", stderr);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+// ============================================================================
+// POWER-OF-TWO ARITHMETIC
+// ============================================================================
+
+/**
+ * is_power_of_two - Checks whether x has exactly one bit set
+ */
+bool is_power_of_two(size_t x)
+{
+    return x != 0 && (x & (x - 1)) == 0;
+}
+
+/**
+ * next_power_of_two - Rounds x up to the next power of two
+ */
+size_t next_power_of_two(size_t x)
+{
+    if (x <= 1)
+    {
+        return 1;
+    }
+
+    x--;
+    for (size_t shift = 1; shift < sizeof(size_t) * 8; shift <<= 1)
+    {
+        x |= x >> shift;
+    }
+
+    return x + 1;
+}
@@ -0,0 +1,250 @@
+/**
+ * @file rseq_linux.c
+ * @brief MemForge restartable sequences (rseq) support for per-CPU caches
+ *
+ * Per-CPU caches are arrays of pointers indexed by the CPU the thread runs
+ * on. They are updated without locks or atomics inside rseq critical
+ * sections: if the thread is preempted, migrated or signalled before the
+ * final (commit) store, the kernel restarts it at an abort handler and the
+ * operation is simply retried.
+ *
+ * Since glibc 2.35 every thread is registered automatically and its rseq
+ * area is found through __rseq_offset; otherwise the area is registered
+ * here. Critical sections are implemented for x86-64 only; elsewhere, or
+ * when registration fails, rseq_thread_area() returns NULL and callers
+ * fall back to per-thread caches.
+ *
+ * @author KyloReneo
+ * @date 2025
+ * @license GPLv3.0
+ */
+
+#include "../../include/memforge/memforge_internal.h"
+
+#if defined(__x86_64__)
+#include <linux/rseq.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(__x86_64__) && defined(SYS_rseq)
+
+// ============================================================================
+// REGISTRATION
+// ============================================================================
+
+/**
+ * @def RSEQ_SIG
+ * @brief Signature preceding every abort handler (same value as glibc)
+ */
+#define RSEQ_SIG 0x53053053
+
+/**
+ * @var ptrdiff_t __rseq_offset
+ * @brief Offset of glibc's rseq area from the thread pointer (glibc >= 2.35)
+ */
+extern const ptrdiff_t __rseq_offset __attribute__((weak));
+
+/**
+ * @var unsigned int __rseq_size
+ * @brief Size of glibc's registered rseq area, 0 when glibc did not register
+ */
+extern const unsigned int __rseq_size __attribute__((weak));
+
+/**
+ * @var struct rseq thread_rseq
+ * @brief rseq area registered by MemForge when the C library did not
+ */
+static _Thread_local struct rseq thread_rseq = {.cpu_id = (__u32)RSEQ_CPU_ID_UNINITIALIZED};
+
+/**
+ * @var struct rseq* thread_rseq_area
+ * @brief The calling thread's registered rseq area (NULL until probed)
+ */
+static _Thread_local struct rseq *thread_rseq_area = NULL;
+
+/**
+ * @var bool thread_rseq_probed
+ * @brief Whether registration has been attempted for the calling thread
+ */
+static _Thread_local bool thread_rseq_probed = false;
+
+/**
+ * rseq_thread_probe - Finds or registers the calling thread's rseq area
+ */
+static struct rseq *rseq_thread_probe(void)
+{
+    if (&__rseq_size != NULL && &__rseq_offset != NULL && __rseq_size != 0)
+    {
+        return (struct rseq *)((char *)__builtin_thread_pointer() + __rseq_offset);
+    }
+
+    if (syscall(SYS_rseq, &thread_rseq, sizeof(thread_rseq), 0, RSEQ_SIG) != 0)
+    {
+        return NULL;
+    }
+
+    return &thread_rseq;
+}
+
+/**
+ * rseq_thread_area - Returns the calling thread's rseq area, or NULL
+ */
+void *rseq_thread_area(void)
+{
+    if (!thread_rseq_probed)
+    {
+        thread_rseq_area = rseq_thread_probe();
+        thread_rseq_probed = true;
+    }
+
+    return thread_rseq_area;
+}
+
+/**
+ * rseq_current_cpu - Returns the CPU the thread is running on right now
+ */
+unsigned int rseq_current_cpu(void *area)
+{
+    return __atomic_load_n(&((struct rseq *)area)->cpu_id, __ATOMIC_RELAXED);
+}
+
+// ============================================================================
+// CRITICAL SECTIONS
+// ============================================================================
+
+/**
+ * @def RSEQ_CS_BEGIN
+ * @brief Emits the rseq_cs descriptor and arms it for the calling thread
+ *
+ * Label 1 starts the critical section, 2 ends it (right after the commit
+ * store) and 4 is the abort handler, preceded by the signature the kernel
+ * checks before restarting there.
+ */
+#define RSEQ_CS_BEGIN                       \
+    ".pushsection __rseq_cs, \"aw\"\n\t"    \
+    ".balign 32\n\t"                        \
+    "3:\n\t"                                \
+    ".long 0x0, 0x0\n\t"                    \
+    ".quad 1f, (2f - 1f), 4f\n\t"           \
+    ".popsection\n\t"                       \
+    "leaq 3b(%%rip), %%rax\n\t"             \
+    "movq %%rax, %[rseq_cs]\n\t"            \
+    "1:\n\t"                                \
+    "cmpl %[cpu], %[cpu_id]\n\t"            \
+    "jnz 4f\n\t"
+
+/**
+ * @def RSEQ_CS_END
+ * @brief Closes the critical section and emits its abort handler
+ */
+#define RSEQ_CS_END                          \
+    "2:\n\t"                                 \
+    ".pushsection __rseq_failure, \"ax\"\n\t" \
+    ".byte 0x0f, 0xb9, 0x3d\n\t"             \
+    ".long 0x53053053\n\t"                   \
+    "4:\n\t"                                 \
+    "jmp %l[aborted]\n\t"                    \
+    ".popsection\n\t"
+
+_Static_assert(RSEQ_SIG == 0x53053053, "abort signature must match RSEQ_CS_END");
+
+/**
+ * rseq_stack_push - Appends ptr to a per-CPU pointer stack
+ * The stack belongs to cpu; the push commits only if the thread is still
+ * running there when it stores the new count
+ */
+int rseq_stack_push(void *area, unsigned int cpu, size_t *count, void **slots, size_t capacity, void *ptr)
+{
+    struct rseq *rs = area;
+
+    __asm__ goto(RSEQ_CS_BEGIN
+                 "movq %[count], %%rcx\n\t"
+                 "cmpq %[capacity], %%rcx\n\t"
+                 "jae %l[full]\n\t"
+                 "movq %[ptr], (%[slots], %%rcx, 8)\n\t"
+                 "incq %%rcx\n\t"
+                 "movq %%rcx, %[count]\n\t" // Commit
+                 RSEQ_CS_END
+                 :
+                 : [rseq_cs] "m"(rs->rseq_cs), [cpu_id] "m"(rs->cpu_id), [cpu] "r"(cpu), [count] "m"(*count),
+                   [slots] "r"(slots), [capacity] "r"(capacity), [ptr] "r"(ptr)
+                 : "memory", "cc", "rax", "rcx"
+                 : full, aborted);
+    return 0;
+full:
+    return 1;
+aborted:
+    return -1;
+}
+
+/**
+ * rseq_stack_pop - Removes the top pointer of a per-CPU pointer stack
+ */
+int rseq_stack_pop(void *area, unsigned int cpu, size_t *count, void **slots, void **out)
+{
+    struct rseq *rs = area;
+
+    __asm__ goto(RSEQ_CS_BEGIN
+                 "movq %[count], %%rcx\n\t"
+                 "testq %%rcx, %%rcx\n\t"
+                 "jz %l[empty]\n\t"
+                 "decq %%rcx\n\t"
+                 "movq (%[slots], %%rcx, 8), %%rax\n\t"
+                 "movq %%rax, (%[out])\n\t"
+                 "movq %%rcx, %[count]\n\t" // Commit
+                 RSEQ_CS_END
+                 :
+                 : [rseq_cs] "m"(rs->rseq_cs), [cpu_id] "m"(rs->cpu_id), [cpu] "r"(cpu), [count] "m"(*count),
+                   [slots] "r"(slots), [out] "r"(out)
+                 : "memory", "cc", "rax", "rcx"
+                 : empty, aborted);
+    return 0;
+empty:
+    return 1;
+aborted:
+    return -1;
+}
+
+#else
+
+// ============================================================================
+// UNSUPPORTED PLATFORMS
+// ============================================================================
+
+/**
+ * rseq_thread_area - rseq critical sections are not available here
+ */
+void *rseq_thread_area(void)
+{
+    return NULL;
+}
+
+/**
+ * rseq_current_cpu - Never called without an rseq area
+ */
+unsigned int rseq_current_cpu(void *area)
+{
+    (void)area;
+    return 0;
+}
+
+/**
+ * rseq_stack_push - Never called without an rseq area
+ */
+int rseq_stack_push(void *area, unsigned int cpu, size_t *count, void **slots, size_t capacity, void *ptr)
+{
+    (void)area, (void)cpu, (void)count, (void)slots, (void)capacity, (void)ptr;
+    return -1;
+}
+
+/**
+ * rseq_stack_pop - Never called without an rseq area
+ */
+int rseq_stack_pop(void *area, unsigned int cpu, size_t *count, void **slots, void **out)
+{
+    (void)area, (void)cpu, (void)count, (void)slots, (void)out;
+    return -1;
+}
+
+#endif
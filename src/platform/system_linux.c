@@ -0,0 +1,229 @@
+/**
+ * @file system_linux.c
+ * @brief MemForge Linux platform layer
+ *
+ * Thin wrappers around the Linux system calls used by the allocator to
+ * obtain and release memory (mmap/munmap, sbrk) and to identify threads.
+ * All other modules go through these functions so the core allocator
+ * stays free of platform-specific code.
+ *
+ * @author KyloReneo
+ * @date 2025
+ * @license GPLv3.0
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // mremap()
+#endif
+
+#include "../../include/memforge/memforge_internal.h"
+
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+// ============================================================================
+// SYSTEM MEMORY MANAGEMENT
+// ============================================================================
+
+/**
+ * system_map - mmap wrapper for anonymous private memory with extra flags
+ * Returns NULL (instead of MAP_FAILED) when the kernel refuses the mapping
+ */
+static void *system_map(size_t size, int flags)
+{
+    void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+    if (ptr == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    return ptr;
+}
+
+/**
+ * system_map_aligned - Maps size bytes starting on an alignment boundary
+ * Over-maps by alignment bytes and trims the unaligned head and tail, so the
+ * only memory left mapped is exactly [result, result + size)
+ */
+static void *system_map_aligned(size_t size, size_t alignment, int flags)
+{
+    size_t map_size = size + alignment;
+    char *raw = system_map(map_size, flags);
+    if (raw == NULL)
+    {
+        return NULL;
+    }
+
+    uintptr_t aligned = ((uintptr_t)raw + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+    size_t head = aligned - (uintptr_t)raw;
+    size_t tail = map_size - head - size;
+
+    if (head > 0)
+    {
+        munmap(raw, head);
+    }
+    if (tail > 0)
+    {
+        munmap((char *)aligned + size, tail);
+    }
+
+    return (void *)aligned;
+}
+
+/**
+ * system_alloc_mmap - Maps size bytes of anonymous, zero-filled memory
+ */
+void *system_alloc_mmap(size_t size)
+{
+    return system_map(size, 0);
+}
+
+/**
+ * system_alloc_mmap_aligned - Maps size bytes starting on an alignment boundary
+ */
+void *system_alloc_mmap_aligned(size_t size, size_t alignment)
+{
+    return system_map_aligned(size, alignment, 0);
+}
+
+/**
+ * system_alloc_mmap_huge - Maps size bytes for huge page backing
+ * Follows memforge_config.huge_pages: hugetlbfs pages are tried first in
+ * MEMFORGE_HUGE_PAGES_HUGETLB mode (size must be a multiple of the huge
+ * page size), otherwise the mapping is aligned to MEMFORGE_HUGE_PAGE_SIZE
+ * and advised with MADV_HUGEPAGE. *huge reports whether either worked.
+ */
+void *system_alloc_mmap_huge(size_t size, size_t alignment, bool *huge)
+{
+    memforge_huge_pages_t mode = memforge_config.huge_pages;
+    *huge = false;
+
+    if (mode == MEMFORGE_HUGE_PAGES_NONE)
+    {
+        return system_map_aligned(size, alignment, 0);
+    }
+
+    if (alignment < MEMFORGE_HUGE_PAGE_SIZE)
+    {
+        alignment = MEMFORGE_HUGE_PAGE_SIZE;
+    }
+
+#ifdef MAP_HUGETLB
+    if (mode == MEMFORGE_HUGE_PAGES_HUGETLB && (size & (MEMFORGE_HUGE_PAGE_SIZE - 1)) == 0)
+    {
+        // hugetlbfs mappings start on a huge page boundary already
+        void *ptr = alignment == MEMFORGE_HUGE_PAGE_SIZE ? system_map(size, MAP_HUGETLB)
+                                                         : system_map_aligned(size, alignment, MAP_HUGETLB);
+        if (ptr != NULL)
+        {
+            *huge = true;
+            return ptr;
+        }
+    }
+#endif
+
+    void *ptr = system_map_aligned(size, alignment, 0);
+    if (ptr != NULL)
+    {
+        *huge = system_advise_huge(ptr, size);
+    }
+
+    return ptr;
+}
+
+/**
+ * system_advise_huge - Asks for transparent huge pages on a mapped range
+ */
+bool system_advise_huge(void *ptr, size_t size)
+{
+#ifdef MADV_HUGEPAGE
+    return madvise(ptr, size, MADV_HUGEPAGE) == 0;
+#else
+    (void)ptr;
+    (void)size;
+    return false;
+#endif
+}
+
+/**
+ * system_remap_mmap - Resizes a mapping, moving it if it cannot grow in place
+ * The kernel moves the page tables, so the contents are never copied.
+ * Returns the new start, or NULL with the old mapping left intact
+ */
+void *system_remap_mmap(void *ptr, size_t old_size, size_t new_size)
+{
+    void *moved = mremap(ptr, old_size, new_size, MREMAP_MAYMOVE);
+    if (moved == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    return moved;
+}
+
+/**
+ * system_purge_pages - Drops the physical pages behind a range
+ * MADV_DONTNEED rather than MADV_FREE: the resident set shrinks at once
+ * instead of under memory pressure, and the pages read back as zeros
+ */
+int system_purge_pages(void *ptr, size_t size)
+{
+    return madvise(ptr, size, MADV_DONTNEED);
+}
+
+/**
+ * system_alloc_sbrk - Extends the program break by size bytes
+ * Returns the start of the new region, or NULL if the break cannot move
+ */
+void *system_alloc_sbrk(size_t size)
+{
+    void *ptr = sbrk((intptr_t)size);
+    if (ptr == (void *)-1)
+    {
+        return NULL;
+    }
+
+    return ptr;
+}
+
+/**
+ * system_free_mmap - Unmaps a region obtained from system_alloc_mmap*
+ */
+void system_free_mmap(void *ptr, size_t size)
+{
+    if (ptr == NULL || size == 0)
+    {
+        return;
+    }
+
+    munmap(ptr, size);
+}
+
+// ============================================================================
+// TIME
+// ============================================================================
+
+/**
+ * system_time_ns - Reads the monotonic clock in nanoseconds
+ */
+uint64_t system_time_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+// ============================================================================
+// THREADING
+// ============================================================================
+
+/**
+ * thread_get_id - Returns the kernel thread id of the calling thread
+ */
+int thread_get_id(void)
+{
+    return (int)syscall(SYS_gettid);
+}